@@ -0,0 +1,243 @@
+#include "allocator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+std::byte* align_up(std::byte* p, std::size_t alignment) {
+    auto address = reinterpret_cast<std::uintptr_t>(p);
+    auto aligned = (address + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    return p + (aligned - address);
+}
+
+} // namespace
+
+
+MonotonicArena::MonotonicArena(std::size_t block_size, std::pmr::memory_resource* upstream)
+    : _upstream{upstream},
+      _initial_block_size{std::max(block_size, 2 * header_size)},
+      _next_block_size{_initial_block_size} {}
+
+
+MonotonicArena::~MonotonicArena() {
+    release();
+}
+
+
+void MonotonicArena::release() noexcept {
+    while (_blocks != nullptr) {
+        Block* next = _blocks->next;
+        _upstream->deallocate(_blocks, _blocks->size, alignof(std::max_align_t));
+        _blocks = next;
+    }
+    _cursor = nullptr;
+    _limit = nullptr;
+    _reserved = 0;
+    _next_block_size = _initial_block_size;
+}
+
+
+void* MonotonicArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    std::byte* start = _cursor == nullptr ? nullptr : align_up(_cursor, alignment);
+    if (start == nullptr || start + bytes > _limit) {
+        // blocks grow geometrically, so a long lived arena needs few of them
+        std::size_t size = std::max(_next_block_size, header_size + bytes + alignment);
+        auto* block = static_cast<Block*>(_upstream->allocate(size, alignof(std::max_align_t)));
+        block->next = _blocks;
+        block->size = size;
+        _blocks = block;
+        _reserved += size;
+        _next_block_size = size * 2;
+
+        _cursor = reinterpret_cast<std::byte*>(block) + header_size;
+        _limit = reinterpret_cast<std::byte*>(block) + size;
+        start = align_up(_cursor, alignment);
+    }
+    _cursor = start + bytes;
+    return start;
+}
+
+
+SizeClassPool::SizeClassPool(std::size_t slab_size, std::pmr::memory_resource* upstream)
+    : _upstream{upstream}, _slab_size{std::max(slab_size, header_size + max_pooled)} {}
+
+
+SizeClassPool::~SizeClassPool() {
+    release();
+}
+
+
+void SizeClassPool::release() noexcept {
+    while (_slabs != nullptr) {
+        Slab* next = _slabs->next;
+        _upstream->deallocate(_slabs, _slabs->size, alignof(std::max_align_t));
+        _slabs = next;
+    }
+    _free.fill(nullptr);
+}
+
+
+std::size_t SizeClassPool::size_class(std::size_t bytes) noexcept {
+    std::size_t rounded = std::bit_ceil(std::max(bytes, min_pooled));
+    return static_cast<std::size_t>(std::countr_zero(rounded) - std::countr_zero(min_pooled));
+}
+
+
+void SizeClassPool::refill(std::size_t index) {
+    std::size_t block = min_pooled << index;
+
+    auto* slab = static_cast<Slab*>(_upstream->allocate(_slab_size, alignof(std::max_align_t)));
+    slab->next = _slabs;
+    slab->size = _slab_size;
+    _slabs = slab;
+
+    // thread the new blocks onto the free list of their class
+    std::byte* first = reinterpret_cast<std::byte*>(slab) + header_size;
+    std::size_t count = (_slab_size - header_size) / block;
+    for (std::size_t i = count; i-- > 0;) {
+        auto* node = reinterpret_cast<FreeNode*>(first + i * block);
+        node->next = _free[index];
+        _free[index] = node;
+    }
+}
+
+
+void* SizeClassPool::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (bytes > max_pooled || alignment > alignof(std::max_align_t))
+        return _upstream->allocate(bytes, alignment);
+
+    // blocks of a class are aligned to their size (capped at max_align_t)
+    std::size_t index = size_class(std::max(bytes, alignment));
+    if (_free[index] == nullptr)
+        refill(index);
+
+    FreeNode* node = _free[index];
+    _free[index] = node->next;
+    return node;
+}
+
+
+void SizeClassPool::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    if (bytes > max_pooled || alignment > alignof(std::max_align_t)) {
+        _upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    std::size_t index = size_class(std::max(bytes, alignment));
+    auto* node = static_cast<FreeNode*>(p);
+    node->next = _free[index];
+    _free[index] = node;
+}
+
+
+namespace detail {
+
+namespace {
+
+#if defined(__linux__)
+
+bool is_mapped(std::size_t bytes) {
+    return bytes >= mmap_threshold;
+}
+
+std::size_t page_rounded(std::size_t bytes) {
+    static const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return (bytes + page - 1) / page * page;
+}
+
+void advise(void* p, std::size_t bytes, bool huge_pages) {
+#if defined(MADV_HUGEPAGE)
+    if (huge_pages)
+        madvise(p, bytes, MADV_HUGEPAGE);
+#else
+    (void)p;
+    (void)bytes;
+    (void)huge_pages;
+#endif
+}
+
+void* map(std::size_t bytes, bool huge_pages) {
+    void* p = mmap(nullptr, page_rounded(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        throw std::bad_alloc{};
+    advise(p, page_rounded(bytes), huge_pages);
+    return p;
+}
+
+#else
+
+bool is_mapped(std::size_t) {
+    return false;
+}
+
+#endif
+
+void* checked(void* p) {
+    if (p == nullptr)
+        throw std::bad_alloc{};
+    return p;
+}
+
+} // namespace
+
+
+void* mapped_allocate(std::size_t bytes, bool huge_pages) {
+#if defined(__linux__)
+    if (is_mapped(bytes))
+        return map(bytes, huge_pages);
+#else
+    (void)huge_pages;
+#endif
+    return checked(std::malloc(std::max<std::size_t>(bytes, 1)));
+}
+
+
+void mapped_deallocate(void* p, std::size_t bytes) noexcept {
+#if defined(__linux__)
+    if (is_mapped(bytes)) {
+        munmap(p, page_rounded(bytes));
+        return;
+    }
+#endif
+    (void)bytes;
+    std::free(p);
+}
+
+
+void* mapped_reallocate(void* p, std::size_t old_bytes, std::size_t new_bytes, bool huge_pages) {
+    bool old_mapped = is_mapped(old_bytes);
+    bool new_mapped = is_mapped(new_bytes);
+
+    if (!old_mapped && !new_mapped)
+        return checked(std::realloc(p, std::max<std::size_t>(new_bytes, 1)));
+
+#if defined(__linux__)
+    if (old_mapped && new_mapped) {
+        void* moved = mremap(p, page_rounded(old_bytes), page_rounded(new_bytes), MREMAP_MAYMOVE);
+        if (moved == MAP_FAILED)
+            throw std::bad_alloc{};
+        advise(moved, page_rounded(new_bytes), huge_pages);
+        return moved;
+    }
+#endif
+
+    // crossing the threshold switches the backend, the contents have to be copied once
+    void* fresh = mapped_allocate(new_bytes, huge_pages);
+    std::memcpy(fresh, p, std::min(old_bytes, new_bytes));
+    mapped_deallocate(p, old_bytes);
+    return fresh;
+}
+
+} // namespace detail
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+/**
+ * hands out memory from large blocks and frees all of it at once.
+ * deallocation is a no-op, so a growing Vector leaves its old buffers behind
+ * until `release` - reserve up front when the final size is known.
+ * not thread safe.
+ */
+class MonotonicArena : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArena(std::size_t block_size = 64 * 1024,
+                            std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    MonotonicArena(const MonotonicArena&) = delete;
+
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() override;
+
+    /**
+     * return all blocks to the upstream resource, invalidates everything handed out.
+     * the next block has the initial size again, so a reused arena doesn't keep growing
+     */
+    void release() noexcept;
+
+    /**
+     * bytes requested from the upstream resource
+     */
+    std::size_t reserved_bytes() const noexcept { return _reserved; }
+
+private:
+    struct Block {
+        Block* next;
+        std::size_t size;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* _upstream;
+    std::size_t _initial_block_size;
+    std::size_t _next_block_size;
+    std::size_t _reserved = 0;
+
+    Block* _blocks = nullptr;
+    std::byte* _cursor = nullptr;
+    std::byte* _limit = nullptr;
+};
+
+
+/**
+ * recycles freed memory in power-of-two size classes (8 bytes up to `max_pooled`),
+ * larger requests and over-aligned ones go to the upstream resource.
+ * memory of the pool is returned upstream when it is destroyed.
+ * not thread safe.
+ */
+class SizeClassPool : public std::pmr::memory_resource {
+public:
+    static constexpr std::size_t min_pooled = 8;
+    static constexpr std::size_t max_pooled = 4096;
+
+    explicit SizeClassPool(std::size_t slab_size = 64 * 1024,
+                           std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    SizeClassPool(const SizeClassPool&) = delete;
+
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    ~SizeClassPool() override;
+
+    /**
+     * return all slabs to the upstream resource, invalidates everything handed out
+     */
+    void release() noexcept;
+
+private:
+    static constexpr std::size_t class_count = 10;  // 8, 16, ..., 4096
+
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    struct Slab {
+        Slab* next;
+        std::size_t size;
+    };
+
+    static std::size_t size_class(std::size_t bytes) noexcept;
+
+    void refill(std::size_t index);
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* _upstream;
+    std::size_t _slab_size;
+
+    std::array<FreeNode*, class_count> _free{};
+    Slab* _slabs = nullptr;
+};
+
+
+namespace detail {
+
+/**
+ * buffers from this size on are mapped instead of malloc'ed
+ */
+inline constexpr std::size_t mmap_threshold = std::size_t{1} << 20;
+
+/**
+ * byte level backend of MappedAllocator
+ */
+void* mapped_allocate(std::size_t bytes, bool huge_pages);
+
+void mapped_deallocate(void* p, std::size_t bytes) noexcept;
+
+void* mapped_reallocate(void* p, std::size_t old_bytes, std::size_t new_bytes, bool huge_pages);
+
+} // namespace detail
+
+
+/**
+ * allocator for large buffers of trivially relocatable types.
+ * buffers below `mmap_threshold` bytes come from malloc, larger ones are mapped anonymously.
+ * `reallocate` keeps the contents and uses realloc or mremap, so a growing Vector
+ * doesn't copy its elements (and with mremap the kernel only moves page table entries).
+ * with `HugePages`, mappings are advised to use transparent huge pages.
+ * mremap is Linux only, elsewhere everything goes through malloc/realloc.
+ */
+template <typename T, bool HugePages = false>
+class MappedAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+    static constexpr std::size_t mmap_threshold = detail::mmap_threshold;
+
+    template <typename U>
+    struct rebind {
+        using other = MappedAllocator<U, HugePages>;
+    };
+
+    MappedAllocator() = default;
+
+    template <typename U>
+    MappedAllocator(const MappedAllocator<U, HugePages>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(detail::mapped_allocate(bytes(n), HugePages));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        detail::mapped_deallocate(p, n * sizeof(T));
+    }
+
+    /**
+     * resize a buffer of `old_n` elements to `new_n`, keeping the bytes of the first min(old_n, new_n)
+     */
+    T* reallocate(T* p, std::size_t old_n, std::size_t new_n) {
+        return static_cast<T*>(detail::mapped_reallocate(p, bytes(old_n), bytes(new_n), HugePages));
+    }
+
+    template <typename U>
+    bool operator==(const MappedAllocator<U, HugePages>&) const noexcept { return true; }
+
+private:
+    static std::size_t bytes(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length{};
+        return n * sizeof(T);
+    }
+};
+
+
+/**
+ * allocator returning memory aligned to `Align` bytes, e.g. 32 or 64 for aligned SIMD loads
+ */
+template <typename T, std::size_t Align>
+class AlignedAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0, "alignment has to be a power of two");
+
+    static constexpr std::size_t alignment = Align;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T))
+            throw std::bad_array_new_length{};
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        ::operator delete(p, n * sizeof(T), std::align_val_t{Align});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const noexcept { return true; }
+};
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define VECTOR_BENCH_RUSAGE 1
+#endif
+
+#include "support.h"
+#include "vector.h"
+
+/**
+ * compares Vector<T> with std::vector<T> for push_back, push_back after reserve, emplace_back,
+ * copy, move, iteration and random access, for int64, std::string (past the small string buffer)
+ * and std::unique_ptr<int64>, at sizes 10, 100, ... up to --max-size.
+ *
+ * every case reports the time per element, the operator new calls per repetition and the peak
+ * heap in use while it ran. growth shows as the difference between push_back and
+ * push_back_reserved and in their allocation counts. the process peak RSS is reported after
+ * each size, it only ever grows. results are printed as JSON, one case per line.
+ *
+ * options: --min-size N --max-size N --work N --seed N, see bench::parse_options
+ */
+
+namespace {
+
+using bench::heap;
+using bench::sink;
+
+
+/**
+ * peak resident set size of the process in kB, 0 where it can't be queried
+ */
+long max_rss_kb() {
+#if defined(VECTOR_BENCH_RUSAGE)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * element types and how to make, emplace and read them.
+ * inputs are built before the timer starts, so only the container's work and the
+ * element's own copy or construction are measured.
+ */
+struct Int64 {
+    using type = std::int64_t;
+    static constexpr const char* name = "int64";
+
+    explicit Int64(std::size_t) {}
+
+    type make(std::size_t i) const { return static_cast<type>(i); }
+
+    template <typename C>
+    void emplace(C& c, std::size_t i) const { c.emplace_back(static_cast<type>(i)); }
+
+    static std::uint64_t read(const type& value) { return static_cast<std::uint64_t>(value); }
+};
+
+struct String {
+    using type = std::string;
+    static constexpr const char* name = "string";
+
+    explicit String(std::size_t n) {
+        _texts.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            _texts.push_back("benchmark string " + std::to_string(i));
+    }
+
+    const type& make(std::size_t i) const { return _texts[i]; }
+
+    template <typename C>
+    void emplace(C& c, std::size_t i) const { c.emplace_back(_texts[i].data(), _texts[i].size()); }
+
+    static std::uint64_t read(const type& value) { return value.size(); }
+
+private:
+    std::vector<std::string> _texts;
+};
+
+struct UniquePtr {
+    using type = std::unique_ptr<std::int64_t>;
+    static constexpr const char* name = "unique_ptr";
+
+    explicit UniquePtr(std::size_t) {}
+
+    type make(std::size_t i) const { return std::make_unique<std::int64_t>(static_cast<std::int64_t>(i)); }
+
+    template <typename C>
+    void emplace(C& c, std::size_t i) const { c.emplace_back(new std::int64_t(static_cast<std::int64_t>(i))); }
+
+    static std::uint64_t read(const type& value) { return static_cast<std::uint64_t>(*value); }
+};
+
+
+struct Result {
+    double ns_per_element = 0;
+    double allocations = 0;
+    std::size_t peak_heap_bytes = 0;
+};
+
+/**
+ * run `body` `reps` times, `elements` elements each
+ */
+template <typename Body>
+Result measure(std::size_t reps, std::size_t elements, Body body) {
+    std::size_t allocations = heap.allocations;
+    std::size_t baseline = heap.live_bytes;
+    heap.peak_bytes = heap.live_bytes;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < reps; ++rep)
+        body();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.ns_per_element = elapsed.count() / static_cast<double>(reps * std::max<std::size_t>(elements, 1));
+    result.allocations = static_cast<double>(heap.allocations - allocations) / static_cast<double>(reps);
+    result.peak_heap_bytes = heap.peak_bytes - baseline;
+    return result;
+}
+
+
+void print(std::string_view type, std::size_t size, std::string_view op, std::string_view container, const Result& r, bool& first) {
+    std::cout << (first ? "" : ",\n") << "    {\"type\": \"" << type << "\", \"size\": " << size
+              << ", \"op\": \"" << op << "\", \"container\": \"" << container << "\""
+              << ", \"ns_per_element\": " << r.ns_per_element
+              << ", \"allocations\": " << r.allocations
+              << ", \"peak_heap_bytes\": " << r.peak_heap_bytes << "}";
+    first = false;
+}
+
+
+/**
+ * all operations for one container, element type and size
+ */
+template <typename Container, typename Elements>
+void run_ops(std::string_view container, const Elements& elements, std::size_t n, const std::vector<std::size_t>& indices,
+             const bench::Options& options, bool& first) {
+    using T = typename Elements::type;
+    const std::size_t reps = std::max<std::size_t>(1, options.work / n);
+    auto report = [&](std::string_view op, const Result& r) { print(Elements::name, n, op, container, r, first); };
+
+    report("push_back", measure(reps, n, [&] {
+        Container c;
+        for (std::size_t i = 0; i < n; ++i)
+            c.push_back(elements.make(i));
+        sink = sink + c.size();
+    }));
+
+    report("push_back_reserved", measure(reps, n, [&] {
+        Container c;
+        c.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+            c.push_back(elements.make(i));
+        sink = sink + c.size();
+    }));
+
+    report("emplace_back", measure(reps, n, [&] {
+        Container c;
+        for (std::size_t i = 0; i < n; ++i)
+            elements.emplace(c, i);
+        sink = sink + c.size();
+    }));
+
+    Container source;
+    source.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        elements.emplace(source, i);
+
+    if constexpr (std::is_copy_constructible_v<T>) {
+        report("copy", measure(reps, n, [&] {
+            Container copy(source);
+            sink = sink + copy.size();
+        }));
+    }
+
+    // moving doesn't depend on n, it is timed per move
+    report("move", measure(std::max<std::size_t>(1, options.work / 10), 1, [&] {
+        Container moved(std::move(source));
+        sink = sink + moved.size();
+        source = std::move(moved);
+    }));
+
+    report("iterate", measure(reps, n, [&] {
+        std::uint64_t sum = 0;
+        for (const auto& item : source)
+            sum += Elements::read(item);
+        sink = sink + sum;
+    }));
+
+    report("random_access", measure(reps, n, [&] {
+        std::uint64_t sum = 0;
+        for (std::size_t index : indices)
+            sum += Elements::read(source[index]);
+        sink = sink + sum;
+    }));
+}
+
+
+template <typename Elements>
+void run_type(const bench::Options& options, bool& first) {
+    for (std::size_t n = options.min_size; n <= options.max_size; n *= 10) {
+        Elements elements{n};
+        std::vector<std::size_t> indices(n);
+        std::mt19937_64 random{options.seed};
+        std::uniform_int_distribution<std::size_t> pick{0, n - 1};
+        for (auto& index : indices)
+            index = pick(random);
+
+        run_ops<Vector<typename Elements::type>>("Vector", elements, n, indices, options, first);
+        run_ops<std::vector<typename Elements::type>>("std::vector", elements, n, indices, options, first);
+        std::cout << ",\n    {\"type\": \"" << Elements::name << "\", \"size\": " << n
+                  << ", \"max_rss_kb\": " << max_rss_kb() << "}";
+
+        if (n > options.max_size / 10)
+            break;
+    }
+}
+
+} // namespace
+
+
+int main(int argc, char** argv) {
+    bench::Options options;
+    try {
+        options = bench::parse_options(argc, argv);
+    } catch (std::exception& err) {
+        std::cerr << err.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << "{\n"
+              << "  \"min_size\": " << options.min_size << ",\n"
+              << "  \"max_size\": " << options.max_size << ",\n"
+              << "  \"work\": " << options.work << ",\n"
+              << "  \"seed\": " << options.seed << ",\n"
+              << "  \"results\": [\n";
+
+    bool first = true;
+    run_type<Int64>(options, first);
+    run_type<String>(options, first);
+    run_type<UniquePtr>(options, first);
+
+    std::cout << "\n  ],\n"
+              << "  \"max_rss_kb\": " << max_rss_kb() << "\n"
+              << "}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "storage.h"
+
+/**
+ * append-only vector that many threads can push_back into at once.
+ * elements live in segments that double in size and are never moved,
+ * so references and iterators stay valid while the vector grows.
+ * a slot is claimed with a compare-exchange on the size once its segment exists,
+ * segments are allocated on first use and published with a compare-exchange.
+ *
+ * push_back, emplace_back, reserve and reading elements obtained from them are thread safe.
+ * size() and iteration see every element only after the writers are done
+ * (joined or otherwise synchronized with), everything else is not thread safe.
+ * `Allocator` has to be safe to call from several threads.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = detail::IndexIterator<ConcurrentVector, false>;
+    using const_iterator = detail::IndexIterator<ConcurrentVector, true>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, value_type>,
+                  "allocator has to allocate value_type");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, pointer>,
+                  "fancy allocator pointers are not supported");
+    static_assert(std::is_nothrow_move_constructible_v<value_type>,
+                  "elements are built before their slot is claimed and moved in, which must not throw");
+
+    /**
+     * size of the first segment, segment k holds first_segment << k elements
+     */
+    static constexpr size_type first_segment = 32;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const allocator_type& alloc) noexcept : _alloc(alloc) {}
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        clear();
+        for (size_type k = 0; k < segment_count; ++k) {
+            if (pointer segment = _segments[k].load(std::memory_order_relaxed))
+                alloc_traits::deallocate(_alloc, segment, segment_size(k));
+        }
+    }
+
+    allocator_type get_allocator() const noexcept { return _alloc; }
+
+    /**
+     * number of claimed slots, includes pushes still in progress
+     */
+    size_type size() const noexcept { return _size.load(std::memory_order_acquire); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * number of elements that fit into the allocated segments before a new one is needed
+     */
+    size_type capacity() const noexcept {
+        size_type total = 0;
+        for (size_type k = 0; k < segment_count && _segments[k].load(std::memory_order_acquire) != nullptr; ++k)
+            total += segment_size(k);
+        return total;
+    }
+
+    /**
+     * allocate the segments for the first `n` elements up front, thread safe
+     */
+    void reserve(size_type n) {
+        if (n == 0)
+            return;
+        for (size_type k = 0; k <= segment_of(n - 1); ++k)
+            segment(k);
+    }
+
+    void push_back(const_reference value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * construct a new element and return a reference that stays valid until the vector is cleared.
+     * elements pushed concurrently end up in no particular order.
+     */
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<value_type, Args&&...>) {
+            pointer slot = claim();
+            alloc_traits::construct(_alloc, slot, std::forward<Args>(args)...);
+            return *slot;
+        } else {
+            // a claimed slot has to be filled, so anything that can throw happens before claiming it
+            value_type value(std::forward<Args>(args)...);
+            pointer slot = claim();
+            alloc_traits::construct(_alloc, slot, std::move(value));
+            return *slot;
+        }
+    }
+
+    /**
+     * destroy all elements, keeps the segments. not thread safe.
+     */
+    void clear() noexcept {
+        size_type n = _size.load(std::memory_order_relaxed);
+        for (size_type i = 0; i < n; ++i)
+            alloc_traits::destroy(_alloc, &(*this)[i]);
+        _size.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * with bounds check
+     */
+    reference at(size_type pos) {
+        if (pos >= size())
+            throw std::out_of_range{"Invalid position"};
+        return (*this)[pos];
+    }
+
+    const_reference at(size_type pos) const {
+        if (pos >= size())
+            throw std::out_of_range{"Invalid position"};
+        return (*this)[pos];
+    }
+
+    /**
+     * without bounds check
+     */
+    reference operator[](size_type index) noexcept {
+        size_type k = segment_of(index);
+        return _segments[k].load(std::memory_order_acquire)[index - segment_start(k)];
+    }
+
+    const_reference operator[](size_type index) const noexcept {
+        size_type k = segment_of(index);
+        return _segments[k].load(std::memory_order_acquire)[index - segment_start(k)];
+    }
+
+    iterator begin() noexcept { return {this, 0}; }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    iterator end() noexcept { return {this, size()}; }
+
+    const_iterator end() const noexcept { return {this, size()}; }
+
+    const_iterator cend() const noexcept { return {this, size()}; }
+
+private:
+    static constexpr size_type segment_count =
+        std::numeric_limits<size_type>::digits - std::countr_zero(first_segment);
+
+    static constexpr size_type segment_size(size_type k) noexcept {
+        return first_segment << k;
+    }
+
+    static constexpr size_type segment_start(size_type k) noexcept {
+        return first_segment * ((size_type{1} << k) - 1);
+    }
+
+    static constexpr size_type segment_of(size_type index) noexcept {
+        return static_cast<size_type>(std::bit_width(index / first_segment + 1)) - 1;
+    }
+
+    /**
+     * the segment `k`, allocated by whichever thread gets there first
+     */
+    pointer segment(size_type k) {
+        pointer current = _segments[k].load(std::memory_order_acquire);
+        if (current != nullptr)
+            return current;
+
+        pointer fresh = alloc_traits::allocate(_alloc, segment_size(k));
+        if (_segments[k].compare_exchange_strong(current, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+            return fresh;
+        // another thread published it first
+        alloc_traits::deallocate(_alloc, fresh, segment_size(k));
+        return current;
+    }
+
+    /**
+     * reserve the next slot. its segment is allocated before the slot is published,
+     * so if that throws no slot is claimed and the vector stays usable.
+     */
+    pointer claim() {
+        size_type index = _size.load(std::memory_order_relaxed);
+        for (;;) {
+            size_type k = segment_of(index);
+            if (k >= segment_count)
+                throw std::length_error{"ConcurrentVector is full"};
+            pointer base = segment(k);
+            if (_size.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+                return base + (index - segment_start(k));
+        }
+    }
+
+    std::atomic<size_type> _size = 0;
+    std::array<std::atomic<pointer>, segment_count> _segments{};
+
+    [[no_unique_address]] allocator_type _alloc = allocator_type();
+};
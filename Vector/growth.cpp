@@ -0,0 +1,109 @@
+#include "growth.h"
+
+#include <mutex>
+
+namespace growth {
+
+namespace {
+
+// never destroyed like the registry, so it can still be locked during static destruction
+std::mutex& registry_mutex() {
+    static std::mutex* mutex = new std::mutex;
+    return *mutex;
+}
+
+/**
+ * `name` as a JSON string literal, with quotes, backslashes and control characters escaped
+ */
+void write_json_string(std::ostream& o, const std::string& name) {
+    static constexpr char hex[] = "0123456789abcdef";
+    o << '"';
+    for (char c : name) {
+        auto byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+            o << '\\' << c;
+        else if (byte < 0x20)
+            o << "\\u00" << hex[byte >> 4] << hex[byte & 0xf];
+        else
+            o << c;
+    }
+    o << '"';
+}
+
+} // namespace
+
+
+Telemetry::Telemetry(std::string name) : _name{std::move(name)} {
+    TelemetryRegistry::global().add(this);
+}
+
+
+Telemetry::Counters Telemetry::counters() const {
+    Counters c;
+    c.name = _name;
+    c.allocations = _allocations.load(std::memory_order_relaxed);
+    c.deallocations = _deallocations.load(std::memory_order_relaxed);
+    c.bytes_allocated = _bytes_allocated.load(std::memory_order_relaxed);
+    c.live_bytes = _live_bytes.load(std::memory_order_relaxed);
+    c.growths = _growths.load(std::memory_order_relaxed);
+    c.bytes_moved = _bytes_moved.load(std::memory_order_relaxed);
+    c.peak_capacity_bytes = _peak_capacity_bytes.load(std::memory_order_relaxed);
+    c.released_buffers = _released_buffers.load(std::memory_order_relaxed);
+    c.wasted_bytes = _wasted_bytes.load(std::memory_order_relaxed);
+    return c;
+}
+
+
+void Telemetry::reset() noexcept {
+    // live bytes describe buffers that still exist, they are kept
+    _allocations = 0;
+    _deallocations = 0;
+    _bytes_allocated = 0;
+    _growths = 0;
+    _bytes_moved = 0;
+    _peak_capacity_bytes = 0;
+    _released_buffers = 0;
+    _wasted_bytes = 0;
+}
+
+
+TelemetryRegistry& TelemetryRegistry::global() {
+    // never destroyed, see the class comment
+    static TelemetryRegistry* registry = new TelemetryRegistry;
+    return *registry;
+}
+
+
+void TelemetryRegistry::add(const Telemetry* telemetry) {
+    std::lock_guard lock{registry_mutex()};
+    _entries.push_back(telemetry);
+}
+
+
+std::vector<Telemetry::Counters> TelemetryRegistry::snapshot() const {
+    std::lock_guard lock{registry_mutex()};
+    std::vector<Telemetry::Counters> result;
+    result.reserve(_entries.size());
+    for (const Telemetry* entry : _entries)
+        result.push_back(entry->counters());
+    return result;
+}
+
+
+void TelemetryRegistry::write_json(std::ostream& o) const {
+    for (const auto& c : snapshot()) {
+        o << "{\"name\": ";
+        write_json_string(o, c.name);
+        o << ", \"allocations\": " << c.allocations
+          << ", \"deallocations\": " << c.deallocations
+          << ", \"bytes_allocated\": " << c.bytes_allocated
+          << ", \"live_bytes\": " << c.live_bytes
+          << ", \"growths\": " << c.growths
+          << ", \"bytes_moved\": " << c.bytes_moved
+          << ", \"peak_capacity_bytes\": " << c.peak_capacity_bytes
+          << ", \"released_buffers\": " << c.released_buffers
+          << ", \"wasted_bytes\": " << c.wasted_bytes << "}\n";
+    }
+}
+
+} // namespace growth
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * growth policies decide the capacity a Vector grows to.
+ * a policy is a type with
+ *   static std::size_t next(std::size_t capacity, std::size_t required, std::size_t element_size)
+ * returning a capacity of at least `required` elements, it is only asked when `required > capacity`.
+ */
+namespace growth {
+
+template <typename Policy>
+concept policy = requires(std::size_t n) {
+    { Policy::next(n, n, n) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * double the capacity, fewest reallocations
+ */
+struct Double {
+    static constexpr std::size_t next(std::size_t capacity, std::size_t required, std::size_t) noexcept {
+        return std::max(capacity * 2, required);
+    }
+};
+
+/**
+ * grow by half, less unused capacity and freed blocks can be reused by later growth
+ */
+struct OneAndHalf {
+    static constexpr std::size_t next(std::size_t capacity, std::size_t required, std::size_t) noexcept {
+        return std::max(capacity + capacity / 2, required);
+    }
+};
+
+/**
+ * grow like `Base`, then round buffers of a page and more up to whole pages,
+ * the rest of the last page would be allocated anyway
+ */
+template <typename Base = Double, std::size_t PageSize = 4096>
+struct PageAware {
+    static_assert(policy<Base>);
+
+    static constexpr std::size_t next(std::size_t capacity, std::size_t required, std::size_t element_size) noexcept {
+        std::size_t elements = Base::next(capacity, required, element_size);
+        std::size_t bytes = elements * element_size;
+        if (bytes < PageSize)
+            return elements;
+        return (bytes + PageSize - 1) / PageSize * PageSize / element_size;
+    }
+};
+
+
+/**
+ * allocation counters of one call site or type, updated by every Vector using
+ * an `Instrumented` policy with the same tag. all counters are in bytes or events.
+ */
+class Telemetry {
+public:
+    struct Counters {
+        std::string name;
+        std::size_t allocations = 0;
+        std::size_t deallocations = 0;
+        std::size_t bytes_allocated = 0;
+        std::size_t live_bytes = 0;
+        std::size_t growths = 0;
+        std::size_t bytes_moved = 0;
+        std::size_t peak_capacity_bytes = 0;
+        std::size_t released_buffers = 0;
+        std::size_t wasted_bytes = 0;
+    };
+
+    /**
+     * registers itself in the registry, which keeps a pointer to it, so a Telemetry
+     * must never be destroyed. Instrumented creates them with new and never deletes them
+     */
+    explicit Telemetry(std::string name);
+
+    Telemetry(const Telemetry&) = delete;
+
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    void record_allocation(std::size_t bytes) noexcept {
+        _allocations.fetch_add(1, std::memory_order_relaxed);
+        _bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        _live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        std::size_t peak = _peak_capacity_bytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !_peak_capacity_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+
+    void record_deallocation(std::size_t bytes) noexcept {
+        _deallocations.fetch_add(1, std::memory_order_relaxed);
+        _live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * a buffer grew, `moved_bytes` were relocated element by element or with memcpy
+     */
+    void record_growth(std::size_t moved_bytes) noexcept {
+        _growths.fetch_add(1, std::memory_order_relaxed);
+        _bytes_moved.fetch_add(moved_bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * a buffer was given up with `unused_bytes` of capacity never filled
+     */
+    void record_release(std::size_t unused_bytes) noexcept {
+        _released_buffers.fetch_add(1, std::memory_order_relaxed);
+        _wasted_bytes.fetch_add(unused_bytes, std::memory_order_relaxed);
+    }
+
+    Counters counters() const;
+
+    void reset() noexcept;
+
+private:
+    std::string _name;
+    std::atomic<std::size_t> _allocations = 0;
+    std::atomic<std::size_t> _deallocations = 0;
+    std::atomic<std::size_t> _bytes_allocated = 0;
+    std::atomic<std::size_t> _live_bytes = 0;
+    std::atomic<std::size_t> _growths = 0;
+    std::atomic<std::size_t> _bytes_moved = 0;
+    std::atomic<std::size_t> _peak_capacity_bytes = 0;
+    std::atomic<std::size_t> _released_buffers = 0;
+    std::atomic<std::size_t> _wasted_bytes = 0;
+};
+
+
+/**
+ * every Telemetry of the program, for exporting.
+ * neither the registry nor the Telemetry objects are ever destroyed, so it can be read
+ * at any time, also from destructors of static objects at program exit
+ */
+class TelemetryRegistry {
+public:
+    static TelemetryRegistry& global();
+
+    void add(const Telemetry* telemetry);
+
+    std::vector<Telemetry::Counters> snapshot() const;
+
+    /**
+     * one JSON object per line, ready for a log shipper
+     */
+    void write_json(std::ostream& o) const;
+
+private:
+    TelemetryRegistry() = default;
+
+    std::vector<const Telemetry*> _entries;
+};
+
+
+namespace detail {
+
+template <typename Tag>
+std::string tag_name() {
+    if constexpr (std::is_void_v<Tag>)
+        return "default";
+    else if constexpr (requires { std::string{Tag::name}; })
+        return std::string{Tag::name};
+    else
+        return typeid(Tag).name();
+}
+
+} // namespace detail
+
+
+/**
+ * grows like `Policy` and records every allocation of the Vector in the Telemetry of `Tag`.
+ * give a call site its own tag type (with an optional `static constexpr const char* name`)
+ * or use the element type as tag for per type numbers.
+ * the counters are shared atomics, they cost a few relaxed atomic adds per allocation.
+ */
+template <typename Policy = Double, typename Tag = void>
+struct Instrumented {
+    static_assert(policy<Policy>);
+
+    static constexpr std::size_t next(std::size_t capacity, std::size_t required, std::size_t element_size) noexcept {
+        return Policy::next(capacity, required, element_size);
+    }
+
+    static Telemetry& telemetry() {
+        // leaked on purpose, the registry and Vectors destroyed at exit still refer to it
+        static Telemetry* instance = new Telemetry{detail::tag_name<Tag>()};
+        return *instance;
+    }
+};
+
+template <typename Policy>
+concept instrumented = policy<Policy> && requires {
+    { Policy::telemetry() } -> std::same_as<Telemetry&>;
+};
+
+} // namespace growth
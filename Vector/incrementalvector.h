@@ -0,0 +1,435 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth.h"
+#include "vector.h"
+
+/**
+ * Vector that grows without a pause: when it runs full the new buffer is allocated,
+ * but the elements stay in the old one and every following push_back moves a few of them over.
+ * both buffers are live until the migration is done, indexing picks the one holding the element.
+ *
+ * a push_back moves at most `migration_step()` elements, ceil(old / (new - old)) for the
+ * capacities of the last growth, 1 for growth::Double and 2 for
+ * growth::OneAndHalf past the first few elements.
+ * that is just enough to finish before the new buffer runs full.
+ *
+ * the price is one extra compare per access, no contiguous data() and up to
+ * old + new capacity of memory during a migration. reserve() and settle() finish it at once.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = growth::Double>
+class IncrementalVector {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using elements = detail::Elements<Allocator>;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = detail::IndexIterator<IncrementalVector, false>;
+    using const_iterator = detail::IndexIterator<IncrementalVector, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, value_type>,
+                  "allocator has to allocate value_type");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, pointer>,
+                  "fancy allocator pointers are not supported");
+    static_assert(growth::policy<Growth>, "Growth has to be a growth policy");
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const allocator_type& alloc) noexcept : _alloc(alloc) {}
+
+    IncrementalVector(std::initializer_list<value_type> l, const allocator_type& alloc = allocator_type())
+        : IncrementalVector(alloc) {
+        reserve(l.size());
+        for (const auto& item : l)
+            emplace_back(item);
+    }
+
+    IncrementalVector(const IncrementalVector& copy)
+        : IncrementalVector(copy, alloc_traits::select_on_container_copy_construction(copy._alloc)) {}
+
+    /**
+     * the copy is a single buffer, whether or not `copy` is migrating.
+     * delegates so that the elements copied so far are destroyed if one throws
+     */
+    IncrementalVector(const IncrementalVector& copy, const allocator_type& alloc) : IncrementalVector(alloc) {
+        reserve(copy._size);
+        for (const auto& item : copy)
+            emplace_back(item);
+    }
+
+    IncrementalVector(IncrementalVector&& move) noexcept
+        : _size(std::exchange(move._size, 0)),
+          _capacity(std::exchange(move._capacity, 0)),
+          _data(std::exchange(move._data, nullptr)),
+          _old(std::exchange(move._old, nullptr)),
+          _old_capacity(std::exchange(move._old_capacity, 0)),
+          _old_size(std::exchange(move._old_size, 0)),
+          _migrated(std::exchange(move._migrated, 0)),
+          _step(std::exchange(move._step, 1)),
+          _alloc(std::move(move._alloc)) {}
+
+    /**
+     * copy assignment
+     */
+    IncrementalVector& operator=(const IncrementalVector& copy) {
+        if (this != &copy) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                if (_alloc != copy._alloc)
+                    release();
+                _alloc = copy._alloc;
+            }
+            IncrementalVector tmp{copy, _alloc};
+            swap_storage(tmp);
+        }
+        return *this;
+    }
+
+    /**
+     * move assignment
+     * moves element by element if the allocators differ and don't propagate
+     */
+    IncrementalVector& operator=(IncrementalVector&& move) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                                                    alloc_traits::is_always_equal::value) {
+        if (this == &move)
+            return *this;
+
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            release();
+            _alloc = std::move(move._alloc);
+            swap_storage(move);
+        } else {
+            if (_alloc == move._alloc) {
+                release();
+                swap_storage(move);
+            } else {
+                IncrementalVector tmp{_alloc};
+                tmp.reserve(move._size);
+                for (auto& item : move)
+                    tmp.emplace_back(std::move(item));
+                swap_storage(tmp);
+                move.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        release();
+    }
+
+    allocator_type get_allocator() const noexcept { return _alloc; }
+
+    size_type size() const noexcept { return _size; }
+
+    /**
+     * capacity of the new buffer, the old one is freed once it is empty
+     */
+    size_type capacity() const noexcept { return _capacity; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    /**
+     * whether elements are still waiting in the old buffer
+     */
+    bool migrating() const noexcept { return _old != nullptr; }
+
+    /**
+     * the most elements a push_back moves during the current migration
+     */
+    size_type migration_step() const noexcept { return _step; }
+
+    /**
+     * finish a running migration at once, e.g. in an idle moment
+     */
+    void settle() {
+        if (migrating())
+            migrate(_old_size - _migrated);
+    }
+
+    /**
+     * make room for at least `new_capacity` elements.
+     * moves all elements at once like Vector::reserve, the explicit call is the place to pay for it.
+     */
+    void reserve(size_type new_capacity) {
+        if (new_capacity <= _capacity)
+            return;
+        settle();
+        pointer new_data = allocate(new_capacity);
+        if constexpr (instrumented)
+            Growth::telemetry().record_growth(_size * sizeof(value_type));
+        try {
+            relocate(_data, _size, new_data);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        deallocate(_data, _capacity);
+        _data = new_data;
+        _capacity = new_capacity;
+    }
+
+    void push_back(const_reference value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (_size == _capacity)
+            grow();
+
+        // constructed before migrating, the arguments may refer to an element that is about to move
+        construct(_data + _size, std::forward<Args>(args)...);
+        ++_size;
+        if (migrating()) {
+            try {
+                migrate(std::min(_step, _old_size - _migrated));
+            } catch (...) {
+                --_size;
+                destroy(_data + _size, 1);
+                throw;
+            }
+        }
+        return _data[_size - 1];
+    }
+
+    void pop_back() {
+        --_size;
+        if (migrating() && _size < _old_size) {
+            // the back is one of the elements that haven't moved yet
+            destroy(_old + _size, 1);
+            _old_size = _size;
+            if (_migrated == _old_size)
+                finish_migration();
+        } else {
+            destroy(_data + _size, 1);
+        }
+    }
+
+    /**
+     * remove all elements, keeps the capacity of the new buffer
+     */
+    void clear() noexcept {
+        if (migrating()) {
+            destroy(_old + _migrated, _old_size - _migrated);
+            destroy(_data, _migrated);
+            destroy(_data + _old_size, _size - _old_size);
+            _old_size = _migrated;
+            finish_migration();
+        } else {
+            destroy(_data, _size);
+        }
+        _size = 0;
+    }
+
+    /**
+     * with bounds check
+     */
+    const_reference at(const size_type pos) const {
+        if(pos < size()){
+            return (*this)[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    reference at(const size_type pos) {
+        if(pos < size()){
+            return (*this)[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    /**
+     * without bounds check
+     */
+    const_reference operator[](size_type index) const noexcept {
+        return index - _migrated < _old_size - _migrated ? _old[index] : _data[index];
+    }
+
+    reference operator[](const size_type index) noexcept {
+        // one unsigned compare for _migrated <= index < _old_size, false when not migrating
+        return index - _migrated < _old_size - _migrated ? _old[index] : _data[index];
+    }
+
+    reference back() noexcept {
+        return (*this)[_size - 1];
+    }
+
+    const_reference back() const noexcept {
+        return (*this)[_size - 1];
+    }
+
+
+    iterator begin() noexcept { return {this, 0}; }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    iterator end() noexcept { return {this, _size}; }
+
+    const_iterator end() const noexcept { return {this, _size}; }
+
+    const_iterator cend() const noexcept { return {this, _size}; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator{cend()}; }
+
+    reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator{cbegin()}; }
+
+    /**
+     * stream an IncrementalVector to an output stream textually
+     */
+    friend std::ostream& operator<<(std::ostream& o, const IncrementalVector& v) {
+        o << "Size: " << v.size() << ", Capacity: " << v.capacity() << std::endl;
+        for (size_type i = 0; i < v.size(); ++i) {
+            if (i > 0)
+                o << ", ";
+            o << v[i];
+        }
+        o << std::endl;
+        return o;
+    }
+
+private:
+    static constexpr bool instrumented = growth::instrumented<Growth>;
+
+    pointer allocate(size_type n) {
+        if (n == 0)
+            return nullptr;
+        pointer p = alloc_traits::allocate(_alloc, n);
+        if constexpr (instrumented)
+            Growth::telemetry().record_allocation(n * sizeof(value_type));
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n) {
+        if (p != nullptr) {
+            alloc_traits::deallocate(_alloc, p, n);
+            if constexpr (instrumented)
+                Growth::telemetry().record_deallocation(n * sizeof(value_type));
+        }
+    }
+
+    template <typename... Args>
+    void construct(pointer p, Args&&... args) {
+        elements::construct(_alloc, p, std::forward<Args>(args)...);
+    }
+
+    void destroy(pointer first, size_type n) noexcept {
+        elements::destroy(_alloc, first, n);
+    }
+
+    /**
+     * see detail::Elements, if it throws nothing was built at `dst` and the originals are intact
+     */
+    void relocate(pointer src, size_type n, pointer dst) {
+        elements::relocate(_alloc, src, n, dst);
+    }
+
+    /**
+     * switch to a new buffer and leave the elements in the old one to be migrated
+     */
+    void grow() {
+        // the step finishes every migration before the buffer runs full, this is only a safeguard
+        settle();
+
+        size_type new_capacity = _capacity == 0 ? 1 : Growth::next(_capacity, _size + 1, sizeof(value_type));
+        pointer new_data = allocate(new_capacity);
+        if (_size == 0) {
+            deallocate(_data, _capacity);
+        } else {
+            if constexpr (instrumented)
+                Growth::telemetry().record_growth(_size * sizeof(value_type));
+            _old = _data;
+            _old_capacity = _capacity;
+            _old_size = _size;
+            _migrated = 0;
+            size_type room = new_capacity - _size;
+            _step = (_size + room - 1) / room;
+        }
+        _data = new_data;
+        _capacity = new_capacity;
+    }
+
+    /**
+     * move the next `n` waiting elements into the new buffer
+     */
+    void migrate(size_type n) {
+        relocate(_old + _migrated, n, _data + _migrated);
+        _migrated += n;
+        if (_migrated == _old_size)
+            finish_migration();
+    }
+
+    void finish_migration() noexcept {
+        deallocate(_old, _old_capacity);
+        _old = nullptr;
+        _old_capacity = 0;
+        _old_size = 0;
+        _migrated = 0;
+        _step = 1;
+    }
+
+    void release() noexcept {
+        clear();
+        deallocate(_data, _capacity);
+        _data = nullptr;
+        _capacity = 0;
+    }
+
+    void swap_storage(IncrementalVector& other) noexcept {
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_data, other._data);
+        std::swap(_old, other._old);
+        std::swap(_old_capacity, other._old_capacity);
+        std::swap(_old_size, other._old_size);
+        std::swap(_migrated, other._migrated);
+        std::swap(_step, other._step);
+    }
+
+    size_type _size = 0;
+    size_type _capacity = 0;
+    pointer _data = nullptr;
+
+    /**
+     * during a migration elements [_migrated, _old_size) are still in _old,
+     * all others are in _data. _old_size is 0 otherwise, so indexing needs no extra test.
+     */
+    pointer _old = nullptr;
+    size_type _old_capacity = 0;
+    size_type _old_size = 0;
+    size_type _migrated = 0;
+    size_type _step = 1;
+
+    [[no_unique_address]] allocator_type _alloc = allocator_type();
+};
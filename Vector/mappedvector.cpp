@@ -0,0 +1,214 @@
+#include "mappedvector.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTOR_HAS_MMAP 1
+#endif
+
+namespace detail {
+
+namespace {
+
+constexpr std::uint64_t magic = 0x31434556'50414d4dULL;  // "MMAPVEC1"
+constexpr std::uint32_t version = 1;
+
+/**
+ * first bytes of the file
+ */
+struct Header {
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t element_size;
+    std::uint64_t size;
+};
+
+static_assert(sizeof(Header) <= MappedFile::header_size);
+
+Header* header(std::byte* map) noexcept {
+    return reinterpret_cast<Header*>(map);
+}
+
+[[noreturn]] void throw_errno(const char* what) {
+    throw std::system_error{errno, std::generic_category(), what};
+}
+
+} // namespace
+
+
+#if defined(VECTOR_HAS_MMAP)
+
+namespace {
+
+std::size_t file_bytes(std::size_t capacity, std::size_t element_size) {
+    if (capacity > (std::size_t(-1) - MappedFile::header_size) / element_size)
+        throw std::length_error{"MappedVector capacity too large"};
+    return MappedFile::header_size + capacity * element_size;
+}
+
+std::byte* map_file(int fd, std::size_t bytes) {
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        throw_errno("mmap");
+    return static_cast<std::byte*>(p);
+}
+
+} // namespace
+
+
+MappedFile::MappedFile(const std::filesystem::path& path, std::size_t element_size) : _element_size{element_size} {
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd < 0)
+        throw_errno("open");
+
+    try {
+        struct stat info{};
+        if (fstat(_fd, &info) != 0)
+            throw_errno("fstat");
+        auto bytes = static_cast<std::size_t>(info.st_size);
+
+        if (bytes == 0) {
+            // a new file, write the header
+            if (ftruncate(_fd, static_cast<off_t>(header_size)) != 0)
+                throw_errno("ftruncate");
+            _map = map_file(_fd, header_size);
+            _mapped_bytes = header_size;
+            *header(_map) = Header{magic, version, static_cast<std::uint32_t>(element_size), 0};
+            return;
+        }
+
+        if (bytes < header_size)
+            throw std::runtime_error{"not a MappedVector file: " + path.string()};
+        _map = map_file(_fd, bytes);
+        _mapped_bytes = bytes;
+        const Header& existing = *header(_map);
+        if (existing.magic != magic || existing.version != version)
+            throw std::runtime_error{"not a MappedVector file: " + path.string()};
+        if (existing.element_size != element_size)
+            throw std::runtime_error{"MappedVector file holds elements of a different size: " + path.string()};
+
+        _capacity = (bytes - header_size) / element_size;
+        if (existing.size > _capacity)
+            throw std::runtime_error{"MappedVector file is truncated: " + path.string()};
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+
+void MappedFile::resize_file(std::size_t capacity) {
+    if (_map == nullptr)
+        throw std::logic_error{"MappedVector was moved from"};
+    std::size_t new_bytes = file_bytes(capacity, _element_size);
+    if (ftruncate(_fd, static_cast<off_t>(new_bytes)) != 0)
+        throw_errno("ftruncate");
+
+#if defined(__linux__)
+    void* p = mremap(_map, _mapped_bytes, new_bytes, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+        throw_errno("mremap");
+    _map = static_cast<std::byte*>(p);
+#else
+    std::byte* fresh = map_file(_fd, new_bytes);
+    munmap(_map, _mapped_bytes);
+    _map = fresh;
+#endif
+    _mapped_bytes = new_bytes;
+    _capacity = capacity;
+}
+
+
+void MappedFile::reserve(std::size_t capacity) {
+    if (capacity > _capacity)
+        resize_file(capacity);
+}
+
+
+void MappedFile::shrink_to_fit() {
+    if (size() < _capacity)
+        resize_file(size());
+}
+
+
+void MappedFile::sync() {
+    if (_map == nullptr)
+        return;
+    if (msync(_map, _mapped_bytes, MS_SYNC) != 0)
+        throw_errno("msync");
+}
+
+
+void MappedFile::close() noexcept {
+    if (_map != nullptr)
+        munmap(_map, _mapped_bytes);
+    if (_fd >= 0)
+        ::close(_fd);
+    _map = nullptr;
+    _mapped_bytes = 0;
+    _fd = -1;
+}
+
+#else
+
+MappedFile::MappedFile(const std::filesystem::path&, std::size_t) {
+    throw std::runtime_error{"MappedVector needs mmap"};
+}
+
+void MappedFile::resize_file(std::size_t) {}
+
+void MappedFile::reserve(std::size_t) {}
+
+void MappedFile::shrink_to_fit() {}
+
+void MappedFile::sync() {}
+
+void MappedFile::close() noexcept {}
+
+#endif
+
+
+MappedFile::MappedFile(MappedFile&& move) noexcept
+    : _fd{std::exchange(move._fd, -1)},
+      _map{std::exchange(move._map, nullptr)},
+      _mapped_bytes{std::exchange(move._mapped_bytes, 0)},
+      _element_size{move._element_size},
+      _capacity{std::exchange(move._capacity, 0)} {}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& move) noexcept {
+    if (this != &move) {
+        close();
+        _fd = std::exchange(move._fd, -1);
+        _map = std::exchange(move._map, nullptr);
+        _mapped_bytes = std::exchange(move._mapped_bytes, 0);
+        _element_size = move._element_size;
+        _capacity = std::exchange(move._capacity, 0);
+    }
+    return *this;
+}
+
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+
+std::size_t MappedFile::size() const noexcept {
+    return _map == nullptr ? 0 : static_cast<std::size_t>(header(_map)->size);
+}
+
+
+void MappedFile::set_size(std::size_t size) noexcept {
+    if (_map != nullptr)
+        header(_map)->size = size;
+}
+
+} // namespace detail
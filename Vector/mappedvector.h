@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "growth.h"
+#include "storage.h"
+
+namespace detail {
+
+/**
+ * byte level backend of MappedVector: a file holding a header and an array of
+ * fixed size elements, mapped shared into memory.
+ * the header records the element size and the number of elements in use,
+ * the rest of the file is capacity.
+ */
+class MappedFile {
+public:
+    /**
+     * bytes before the first element, elements can be aligned up to this
+     */
+    static constexpr std::size_t header_size = 64;
+
+    /**
+     * open `path` or create it if it doesn't exist.
+     * throws std::system_error if the file can't be opened or mapped
+     * and std::runtime_error if it holds elements of a different size.
+     */
+    MappedFile(const std::filesystem::path& path, std::size_t element_size);
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& move) noexcept;
+
+    MappedFile& operator=(MappedFile&& move) noexcept;
+
+    /**
+     * unmaps and closes the file, without waiting for the data to reach the disk
+     */
+    ~MappedFile();
+
+    /**
+     * nullptr once the file was moved from
+     */
+    std::byte* elements() const noexcept { return _map == nullptr ? nullptr : _map + header_size; }
+
+    /**
+     * 0 once the file was moved from
+     */
+    std::size_t size() const noexcept;
+
+    /**
+     * only 0 can be stored once the file was moved from, it is ignored
+     */
+    void set_size(std::size_t size) noexcept;
+
+    std::size_t capacity() const noexcept { return _capacity; }
+
+    /**
+     * extend the file to hold `capacity` elements and remap it, new elements read as zero bytes.
+     * throws std::logic_error once the file was moved from
+     */
+    void reserve(std::size_t capacity);
+
+    /**
+     * truncate the file to the elements in use
+     */
+    void shrink_to_fit();
+
+    /**
+     * block until all changes are written to the file
+     */
+    void sync();
+
+private:
+    void resize_file(std::size_t capacity);
+
+    void close() noexcept;
+
+    int _fd = -1;
+    std::byte* _map = nullptr;
+    // the length of the mapping, the file may end in a partial element
+    std::size_t _mapped_bytes = 0;
+    std::size_t _element_size = 0;
+    std::size_t _capacity = 0;
+};
+
+} // namespace detail
+
+
+/**
+ * Vector whose elements live in a file. opening an existing file maps it
+ * without reading or copying anything, the pages are loaded on first access.
+ * changes reach the file through the page cache, `sync()` waits until they are on disk.
+ * the file has the host's byte order and layout of T, it is not a portable format.
+ * a moved-from MappedVector is empty, adding elements to it throws std::logic_error.
+ * POSIX only.
+ */
+template <typename T, typename Growth = growth::Double>
+class MappedVector : public detail::ContiguousAccess<MappedVector<T, Growth>, T> {
+public:
+    /**
+     *  associated types
+     */
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(std::is_trivially_copyable_v<value_type>, "elements are stored as raw bytes in the file");
+    static_assert(alignof(value_type) <= detail::MappedFile::header_size, "over-aligned types are not supported");
+    static_assert(growth::policy<Growth>, "Growth has to be a growth policy");
+
+    /**
+     * open the vector stored in `path`, an empty one is created if the file doesn't exist
+     */
+    explicit MappedVector(const std::filesystem::path& path) : _file{path, sizeof(value_type)} {}
+
+    size_type size() const noexcept { return _file.size(); }
+
+    size_type capacity() const noexcept { return _file.capacity(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    pointer data() noexcept { return reinterpret_cast<pointer>(_file.elements()); }
+
+    const_pointer data() const noexcept { return reinterpret_cast<const_pointer>(_file.elements()); }
+
+    /**
+     * make room for at least `new_capacity` elements, grows the file at most once
+     */
+    void reserve(size_type new_capacity) {
+        if (new_capacity > capacity())
+            _file.reserve(new_capacity);
+    }
+
+    /**
+     * truncate the file to the elements in use
+     */
+    void shrink_to_fit() {
+        _file.shrink_to_fit();
+    }
+
+    /**
+     * change the number of elements, new ones are zero bytes.
+     * pop_back and clear leave the old bytes in the file, so growing zeroes them here
+     */
+    void resize(size_type new_size) {
+        reserve(new_size);
+        if (new_size > size())
+            std::memset(static_cast<void*>(data() + size()), 0, (new_size - size()) * sizeof(value_type));
+        _file.set_size(new_size);
+    }
+
+    void push_back(const_reference value) {
+        emplace_back(value);
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        // the arguments may refer to an element, remapping would move it
+        value_type value(std::forward<Args>(args)...);
+        size_type n = size();
+        if (n == capacity())
+            _file.reserve(std::max(Growth::next(n, n + 1, sizeof(value_type)), min_capacity));
+        data()[n] = value;
+        _file.set_size(n + 1);
+        return data()[n];
+    }
+
+    void pop_back() {
+        _file.set_size(size() - 1);
+    }
+
+    /**
+     * remove all elements, the file keeps its capacity
+     */
+    void clear() noexcept {
+        _file.set_size(0);
+    }
+
+    /**
+     * durability point: returns once all changes are written to the file
+     */
+    void sync() {
+        _file.sync();
+    }
+
+private:
+    /**
+     * a fresh file starts with room for a page worth of small elements
+     */
+    static constexpr size_type min_capacity = 4096 / sizeof(value_type) > 0 ? 4096 / sizeof(value_type) : 1;
+
+    detail::MappedFile _file;
+};
@@ -0,0 +1,45 @@
+#include "packedvector.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_POPCNT_X86 1
+#endif
+
+namespace detail {
+
+namespace {
+
+std::size_t popcount_words(const std::uint64_t* words, std::size_t n) noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        total += static_cast<std::size_t>(std::popcount(words[i]));
+    return total;
+}
+
+#if defined(VECTOR_POPCNT_X86)
+/**
+ * the same loop, compiled to the popcnt instruction instead of a bit twiddling sequence
+ */
+[[gnu::target("popcnt")]] std::size_t popcount_words_popcnt(const std::uint64_t* words, std::size_t n) noexcept {
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        total += static_cast<std::size_t>(std::popcount(words[i]));
+    return total;
+}
+#endif
+
+} // namespace
+
+
+std::size_t popcount(const std::uint64_t* words, std::size_t n) noexcept {
+#if defined(VECTOR_POPCNT_X86)
+    static const bool has_popcnt = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("popcnt") != 0;
+    }();
+    if (has_popcnt)
+        return popcount_words_popcnt(words, n);
+#endif
+    return popcount_words(words, n);
+}
+
+} // namespace detail
@@ -0,0 +1,674 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth.h"
+#include "vector.h"
+
+namespace detail {
+
+/**
+ * number of set bits in `n` words, uses the popcnt instruction where the cpu has it
+ */
+std::size_t popcount(const std::uint64_t* words, std::size_t n) noexcept;
+
+/**
+ * smallest unsigned type holding `Bits` bits
+ */
+template <unsigned Bits>
+using packed_uint_t = std::conditional_t<Bits <= 8, std::uint8_t,
+                      std::conditional_t<Bits <= 16, std::uint16_t,
+                      std::conditional_t<Bits <= 32, std::uint32_t, std::uint64_t>>>;
+
+} // namespace detail
+
+
+/**
+ * vector of bools packed one bit per element into 64 bit words, an eighth of the memory
+ * and cache a byte per flag takes. the words are a Vector of their own, so the allocator
+ * (rebound to the word type) and the growth policy work as for every other Vector.
+ *
+ * a separate type instead of a Vector<bool> specialization, so generic code using Vector<T>
+ * keeps real references and a T* data(). the interface follows Vector's, except that
+ * elements are reached through a proxy reference, like std::vector<bool>, and data()
+ * returns the words.
+ * bits past size() are always zero, so the word level kernels don't need to mask.
+ */
+template <typename Allocator = std::allocator<bool>, typename Growth = growth::Double>
+class BitVector {
+    class bit_reference;
+
+public:
+    using word_type = std::uint64_t;
+
+private:
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+    using words_type = Vector<word_type, word_allocator, Growth>;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = bool;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = bit_reference;
+    using const_reference = bool;
+    using iterator = detail::IndexIterator<BitVector, false>;
+    using const_iterator = detail::IndexIterator<BitVector, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static constexpr size_type word_bits = std::numeric_limits<word_type>::digits;
+
+    BitVector() = default;
+
+    explicit BitVector(const allocator_type& alloc) noexcept : _words(word_allocator(alloc)) {}
+
+    BitVector(size_type n, bool default_val, const allocator_type& alloc = allocator_type())
+        : _words(words_for(n), default_val ? ~word_type{0} : word_type{0}, word_allocator(alloc)), _size(n) {
+        clear_tail();
+    }
+
+    BitVector(std::initializer_list<bool> l, const allocator_type& alloc = allocator_type())
+        : _words(word_allocator(alloc)) {
+        reserve(l.size());
+        for (bool item : l)
+            push_back(item);
+    }
+
+    BitVector(const BitVector& copy) = default;
+
+    /**
+     * the moved-from vector is left empty
+     */
+    BitVector(BitVector&& move) noexcept
+        : _words(std::move(move._words)), _size(std::exchange(move._size, 0)) {}
+
+    BitVector& operator=(const BitVector& copy) = default;
+
+    BitVector& operator=(BitVector&& move) noexcept(std::is_nothrow_move_assignable_v<words_type>) {
+        if (this != &move) {
+            _words = std::move(move._words);
+            _size = std::exchange(move._size, 0);
+        }
+        return *this;
+    }
+
+    void swap(BitVector& other) noexcept {
+        _words.swap(other._words);
+        std::swap(_size, other._size);
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(_words.get_allocator()); }
+
+    size_type size() const noexcept { return _size; }
+
+    size_type capacity() const noexcept { return _words.capacity() * word_bits; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    /**
+     * the packed words, element i is bit i % 64 of word i / 64
+     */
+    word_type* data() noexcept { return _words.data(); }
+
+    const word_type* data() const noexcept { return _words.data(); }
+
+    size_type word_count() const noexcept { return _words.size(); }
+
+    /**
+     * make room for at least `new_capacity` elements, grows at most once
+     */
+    void reserve(size_type new_capacity) {
+        _words.reserve(words_for(new_capacity));
+    }
+
+    /**
+     * give back unused capacity
+     */
+    void shrink_to_fit() {
+        _words.shrink_to_fit();
+    }
+
+    void push_back(bool value) {
+        if (_size % word_bits == 0)
+            _words.push_back(0);
+        _words[_size / word_bits] |= word_type{value} << (_size % word_bits);
+        ++_size;
+    }
+
+    reference emplace_back(bool value) {
+        push_back(value);
+        return (*this)[_size - 1];
+    }
+
+    void pop_back() {
+        --_size;
+        if (_size % word_bits == 0)
+            _words.pop_back();
+        else
+            _words[_size / word_bits] &= ~(word_type{1} << (_size % word_bits));
+    }
+
+    /**
+     * remove all elements, the capacity is kept
+     */
+    void clear() noexcept {
+        _words.clear();
+        _size = 0;
+    }
+
+    /**
+     * insert [first, last) before `pos`, the range must not be part of this vector
+     * @return iterator to the first inserted element
+     */
+    template <std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        auto offset = static_cast<size_type>(pos - cbegin());
+
+        if constexpr (std::forward_iterator<InputIt>) {
+            auto count = static_cast<size_type>(std::distance(first, last));
+            size_type old_size = _size;
+            reserve(_size + count);
+            for (size_type i = 0; i < count; ++i)
+                push_back(false);
+            // shift the tail up from the back, then fill the gap
+            for (size_type i = old_size; i > offset; --i)
+                assign(i - 1 + count, get(i - 1));
+            for (size_type i = 0; i < count; ++i, ++first)
+                assign(offset + i, static_cast<bool>(*first));
+        } else {
+            // single pass input: collect the bits first
+            BitVector items{get_allocator()};
+            for (; first != last; ++first)
+                items.push_back(static_cast<bool>(*first));
+            insert(pos, items.cbegin(), items.cend());
+        }
+        return begin() + static_cast<difference_type>(offset);
+    }
+
+    /**
+     * append [first, last)
+     */
+    template <std::input_iterator InputIt>
+    void append(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>)
+            reserve(_size + static_cast<size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+            push_back(static_cast<bool>(*first));
+    }
+
+    /**
+     * invert every element
+     */
+    void flip() noexcept {
+        for (word_type& word : _words)
+            word = ~word;
+        clear_tail();
+    }
+
+    /**
+     * number of elements that are true
+     */
+    size_type count() const noexcept {
+        return detail::popcount(_words.data(), _words.size());
+    }
+
+    /**
+     * index of the first element equal to `value`, size() if there is none
+     */
+    size_type find_first(bool value = true) const noexcept {
+        return find_next(0, value);
+    }
+
+    /**
+     * index of the first element equal to `value` at or after `pos`, size() if there is none
+     */
+    size_type find_next(size_type pos, bool value = true) const noexcept {
+        if (pos >= _size)
+            return _size;
+        const word_type flip_mask = value ? 0 : ~word_type{0};
+        size_type w = pos / word_bits;
+        // the bits before `pos` are masked off in the first word
+        word_type word = (_words[w] ^ flip_mask) & (~word_type{0} << (pos % word_bits));
+        while (word == 0) {
+            if (++w == _words.size())
+                return _size;
+            word = _words[w] ^ flip_mask;
+        }
+        size_type found = w * word_bits + static_cast<size_type>(std::countr_zero(word));
+        // searching for false finds the zero bits past the end
+        return found < _size ? found : _size;
+    }
+
+    /**
+     * with bounds check
+     */
+    const_reference at(const size_type pos) const {
+        if(pos < _size){
+            return (*this)[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    reference at(const size_type pos) {
+        if(pos < _size){
+            return (*this)[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    /**
+     * without bounds check
+     */
+    const_reference operator[](size_type index) const noexcept {
+        return get(index);
+    }
+
+    reference operator[](const size_type index) noexcept {
+        return {&_words[index / word_bits], word_type{1} << (index % word_bits)};
+    }
+
+
+    iterator begin() noexcept { return {this, 0}; }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    iterator end() noexcept { return {this, _size}; }
+
+    const_iterator end() const noexcept { return {this, _size}; }
+
+    const_iterator cend() const noexcept { return {this, _size}; }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator{cend()}; }
+
+    reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator{cbegin()}; }
+
+    /**
+     * stream a BitVector to an output stream textually
+     */
+    friend std::ostream& operator<<(std::ostream& o, const BitVector& v) {
+        o << "Size: " << v.size() << ", Capacity: " << v.capacity() << std::endl;
+        for (size_type i = 0; i < v.size(); ++i) {
+            if (i > 0)
+                o << ", ";
+            o << v[i];
+        }
+        o << std::endl;
+        return o;
+    }
+
+private:
+    static constexpr size_type words_for(size_type bits) noexcept {
+        return (bits + word_bits - 1) / word_bits;
+    }
+
+    bool get(size_type index) const noexcept {
+        return (_words[index / word_bits] >> (index % word_bits)) & 1;
+    }
+
+    void assign(size_type index, bool value) noexcept {
+        word_type mask = word_type{1} << (index % word_bits);
+        _words[index / word_bits] = value ? _words[index / word_bits] | mask : _words[index / word_bits] & ~mask;
+    }
+
+    /**
+     * zero the bits of the last word past size()
+     */
+    void clear_tail() noexcept {
+        if (_size % word_bits != 0)
+            _words[_size / word_bits] &= ~(~word_type{0} << (_size % word_bits));
+    }
+
+    words_type _words;
+    size_type _size = 0;
+};
+
+
+/**
+ * proxy for one bit of a BitVector
+ */
+template <typename Allocator, typename Growth>
+class BitVector<Allocator, Growth>::bit_reference {
+public:
+    bit_reference(word_type* word, word_type mask) noexcept : _word{word}, _mask{mask} {}
+
+    operator bool() const noexcept { return (*_word & _mask) != 0; }
+
+    /**
+     * overwrite the bit, the proxy itself keeps referring to the same bit
+     */
+    const bit_reference& operator=(bool value) const noexcept {
+        if (value)
+            *_word |= _mask;
+        else
+            *_word &= ~_mask;
+        return *this;
+    }
+
+    const bit_reference& operator=(const bit_reference& other) const noexcept {
+        return *this = static_cast<bool>(other);
+    }
+
+    void flip() const noexcept { *_word ^= _mask; }
+
+    /**
+     * swaps the bits, not the proxies, for algorithms like std::sort
+     */
+    friend void swap(const bit_reference& a, const bit_reference& b) noexcept {
+        bool tmp = a;
+        a = static_cast<bool>(b);
+        b = tmp;
+    }
+
+private:
+    word_type* _word;
+    word_type _mask;
+};
+
+
+/**
+ * vector of unsigned integers stored in `Bits` bits each, back to back in 64 bit words.
+ * an element can straddle two words. meant for small ids and codes: 1 million
+ * values below 4096 take 1.5 MB with Bits = 12 instead of 8 MB as size_t.
+ *
+ * single elements are read and written with shifts and masks, unpack() decodes ranges
+ * 64 elements (exactly `Bits` words) at a time with all shifts known at compile time.
+ */
+template <unsigned Bits, typename Allocator = std::allocator<detail::packed_uint_t<Bits>>, typename Growth = growth::Double>
+class PackedIntVector {
+public:
+    using word_type = std::uint64_t;
+
+private:
+    using word_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<word_type>;
+    using words_type = Vector<word_type, word_allocator, Growth>;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = detail::packed_uint_t<Bits>;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using const_reference = value_type;
+    using iterator = detail::IndexIterator<PackedIntVector, true>;
+    using const_iterator = iterator;
+
+    static_assert(Bits >= 1 && Bits <= 64, "Bits has to be between 1 and 64");
+
+    static constexpr size_type word_bits = std::numeric_limits<word_type>::digits;
+
+    /**
+     * largest value an element can hold
+     */
+    static constexpr value_type max_value = static_cast<value_type>(~word_type{0} >> (word_bits - Bits));
+
+    PackedIntVector() = default;
+
+    explicit PackedIntVector(const allocator_type& alloc) noexcept : _words(word_allocator(alloc)) {}
+
+    PackedIntVector(std::initializer_list<value_type> l, const allocator_type& alloc = allocator_type())
+        : _words(word_allocator(alloc)) {
+        reserve(l.size());
+        for (value_type item : l)
+            push_back(item);
+    }
+
+    PackedIntVector(const PackedIntVector& copy) = default;
+
+    /**
+     * the moved-from vector is left empty
+     */
+    PackedIntVector(PackedIntVector&& move) noexcept
+        : _words(std::move(move._words)), _size(std::exchange(move._size, 0)) {}
+
+    PackedIntVector& operator=(const PackedIntVector& copy) = default;
+
+    PackedIntVector& operator=(PackedIntVector&& move) noexcept(std::is_nothrow_move_assignable_v<words_type>) {
+        if (this != &move) {
+            _words = std::move(move._words);
+            _size = std::exchange(move._size, 0);
+        }
+        return *this;
+    }
+
+    void swap(PackedIntVector& other) noexcept {
+        _words.swap(other._words);
+        std::swap(_size, other._size);
+    }
+
+    allocator_type get_allocator() const noexcept { return allocator_type(_words.get_allocator()); }
+
+    size_type size() const noexcept { return _size; }
+
+    size_type capacity() const noexcept { return _words.capacity() * word_bits / Bits; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    /**
+     * the packed words, element i starts at bit i * Bits
+     */
+    const word_type* data() const noexcept { return _words.data(); }
+
+    size_type word_count() const noexcept { return _words.size(); }
+
+    /**
+     * make room for at least `new_capacity` elements, grows at most once
+     */
+    void reserve(size_type new_capacity) {
+        _words.reserve(words_for(new_capacity));
+    }
+
+    /**
+     * give back unused capacity
+     */
+    void shrink_to_fit() {
+        _words.shrink_to_fit();
+    }
+
+    /**
+     * throws std::out_of_range if `value` doesn't fit into `Bits` bits
+     */
+    void push_back(value_type value) {
+        check(value);
+        if (_words.size() < words_for(_size + 1))
+            _words.push_back(0);
+        write(_size, value);
+        ++_size;
+    }
+
+    /**
+     * elements are values, so this returns the stored value instead of a reference
+     */
+    const_reference emplace_back(value_type value) {
+        push_back(value);
+        return value;
+    }
+
+    void pop_back() {
+        write(--_size, 0);
+        if (_words.size() > words_for(_size))
+            _words.pop_back();
+    }
+
+    /**
+     * remove all elements, the capacity is kept
+     */
+    void clear() noexcept {
+        _words.clear();
+        _size = 0;
+    }
+
+    /**
+     * insert [first, last) before `pos`, the range must not be part of this vector.
+     * throws std::out_of_range and leaves the vector unchanged if a value doesn't fit into `Bits` bits
+     * @return iterator to the first inserted element
+     */
+    template <std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        auto offset = static_cast<size_type>(pos - cbegin());
+
+        if constexpr (std::forward_iterator<InputIt>) {
+            auto count = static_cast<size_type>(std::distance(first, last));
+            for (InputIt it = first; it != last; ++it)
+                check(static_cast<value_type>(*it));
+            size_type old_size = _size;
+            reserve(_size + count);
+            for (size_type i = 0; i < count; ++i)
+                push_back(0);
+            // shift the tail up from the back, then fill the gap
+            for (size_type i = old_size; i > offset; --i)
+                write(i - 1 + count, (*this)[i - 1]);
+            for (size_type i = 0; i < count; ++i, ++first)
+                write(offset + i, static_cast<value_type>(*first));
+        } else {
+            // single pass input: collect the values first
+            PackedIntVector items{get_allocator()};
+            for (; first != last; ++first)
+                items.push_back(static_cast<value_type>(*first));
+            insert(pos, items.cbegin(), items.cend());
+        }
+        return begin() + static_cast<difference_type>(offset);
+    }
+
+    /**
+     * overwrite the element at `index`, without bounds check.
+     * throws std::out_of_range if `value` doesn't fit into `Bits` bits
+     */
+    void set(size_type index, value_type value) {
+        check(value);
+        write(index, value);
+    }
+
+    /**
+     * with bounds check
+     */
+    const_reference at(const size_type pos) const {
+        if(pos < _size){
+            return (*this)[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    /**
+     * without bounds check
+     */
+    const_reference operator[](size_type index) const noexcept {
+        size_type bit = index * Bits;
+        size_type w = bit / word_bits;
+        size_type offset = bit % word_bits;
+        word_type value = _words[w] >> offset;
+        if constexpr (word_bits % Bits != 0) {
+            if (offset + Bits > word_bits)
+                value |= _words[w + 1] << (word_bits - offset);
+        }
+        return static_cast<value_type>(value & mask);
+    }
+
+    /**
+     * decode `count` elements starting at `first` into `out`, without bounds check
+     */
+    void unpack(size_type first, size_type count, value_type* out) const noexcept {
+        size_type last = first + count;
+        // single elements up to a 64 element boundary, there the elements start on a word
+        for (; first < last && first % word_bits != 0; ++first)
+            *out++ = (*this)[first];
+        for (; last - first >= word_bits; first += word_bits, out += word_bits)
+            unpack_block(_words.data() + first / word_bits * Bits, out, std::make_index_sequence<word_bits>{});
+        for (; first < last; ++first)
+            *out++ = (*this)[first];
+    }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    const_iterator end() const noexcept { return {this, _size}; }
+
+    const_iterator cend() const noexcept { return {this, _size}; }
+
+    /**
+     * stream a PackedIntVector to an output stream textually
+     */
+    friend std::ostream& operator<<(std::ostream& o, const PackedIntVector& v) {
+        o << "Size: " << v.size() << ", Capacity: " << v.capacity() << std::endl;
+        for (size_type i = 0; i < v.size(); ++i) {
+            if (i > 0)
+                o << ", ";
+            o << +v[i];
+        }
+        o << std::endl;
+        return o;
+    }
+
+private:
+    static constexpr word_type mask = max_value;
+
+    static constexpr size_type words_for(size_type n) noexcept {
+        return (n * Bits + word_bits - 1) / word_bits;
+    }
+
+    static void check(value_type value) {
+        if constexpr (Bits < std::numeric_limits<value_type>::digits) {
+            if (value > max_value)
+                throw std::out_of_range{"Value does not fit"};
+        }
+    }
+
+    void write(size_type index, value_type value) noexcept {
+        size_type bit = index * Bits;
+        size_type w = bit / word_bits;
+        size_type offset = bit % word_bits;
+        _words[w] = (_words[w] & ~(mask << offset)) | (word_type{value} << offset);
+        if constexpr (word_bits % Bits != 0) {
+            if (offset + Bits > word_bits) {
+                size_type spill = word_bits - offset;
+                _words[w + 1] = (_words[w + 1] & ~(mask >> spill)) | (word_type{value} >> spill);
+            }
+        }
+    }
+
+    /**
+     * element `J` of a block of 64, all offsets are constants
+     */
+    template <size_type J>
+    static value_type extract(const word_type* in) noexcept {
+        constexpr size_type bit = J * Bits;
+        constexpr size_type w = bit / word_bits;
+        constexpr size_type offset = bit % word_bits;
+        word_type value = in[w] >> offset;
+        if constexpr (offset + Bits > word_bits)
+            value |= in[w + 1] << (word_bits - offset);
+        return static_cast<value_type>(value & mask);
+    }
+
+    template <size_type... J>
+    static void unpack_block(const word_type* in, value_type* out, std::index_sequence<J...>) noexcept {
+        ((out[J] = extract<J>(in)), ...);
+    }
+
+    words_type _words;
+    size_type _size = 0;
+};
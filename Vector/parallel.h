@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "threadpool.h"
+#include "vector.h"
+
+/**
+ * how a parallel algorithm splits its work
+ */
+struct ParallelOptions {
+    /**
+     * elements per task, 0 splits into a few tasks per worker
+     */
+    std::size_t grain = 0;
+
+    /**
+     * below this many elements everything runs on the calling thread
+     */
+    std::size_t serial_threshold = 4096;
+
+    /**
+     * nullptr uses ThreadPool::global()
+     */
+    ThreadPool* pool = nullptr;
+};
+
+
+namespace detail {
+
+inline ThreadPool& pool_of(const ParallelOptions& options) {
+    return options.pool != nullptr ? *options.pool : ThreadPool::global();
+}
+
+inline std::size_t grain_of(std::size_t n, const ParallelOptions& options, const ThreadPool& pool) {
+    if (options.grain != 0)
+        return options.grain;
+    // a few chunks per worker keeps them busy when chunks take unequal time
+    std::size_t chunks = pool.size() * 4;
+    return std::max<std::size_t>(1, (n + chunks - 1) / chunks);
+}
+
+/**
+ * call `body(first, last)` for consecutive chunks of [0, n), chunk `i` is [i * grain, ...).
+ * the caller runs the last chunk itself.
+ */
+template <typename Body>
+void for_chunks(std::size_t n, const ParallelOptions& options, Body&& body) {
+    if (n == 0)
+        return;
+    ThreadPool& pool = pool_of(options);
+    std::size_t grain = grain_of(n, options, pool);
+    if (n < options.serial_threshold || n <= grain || pool.size() < 2) {
+        body(std::size_t{0}, n);
+        return;
+    }
+
+    TaskGroup group{pool};
+    std::size_t first = 0;
+    for (; first + grain < n; first += grain)
+        group.run([&body, first, grain] { body(first, first + grain); });
+    body(first, n);
+    group.wait();
+}
+
+} // namespace detail
+
+
+/**
+ * call `f(element)` for every element, in no particular order
+ */
+template <typename T, typename Allocator, typename Growth, typename F>
+void parallel_for_each(Vector<T, Allocator, Growth>& v, F f, const ParallelOptions& options = {}) {
+    T* data = v.data();
+    detail::for_chunks(v.size(), options, [data, &f](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+            f(data[i]);
+    });
+}
+
+/**
+ * out[i] = op(in[i]) for every element of `in`, `out` needs at least as many elements
+ */
+template <typename T, typename InAllocator, typename InGrowth, typename U, typename OutAllocator, typename OutGrowth,
+          typename Op>
+void parallel_transform(const Vector<T, InAllocator, InGrowth>& in, Vector<U, OutAllocator, OutGrowth>& out, Op op,
+                        const ParallelOptions& options = {}) {
+    if (out.size() < in.size())
+        throw std::out_of_range{"transform target too small"};
+
+    const T* src = in.data();
+    U* dst = out.data();
+    detail::for_chunks(in.size(), options, [src, dst, &op](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+            dst[i] = op(src[i]);
+    });
+}
+
+/**
+ * fold all elements with `op`, which has to be associative.
+ * chunks are folded separately and combined in order, `init` is used once.
+ */
+template <typename T, typename Allocator, typename Growth, typename R, typename Op = std::plus<>>
+R parallel_reduce(const Vector<T, Allocator, Growth>& v, R init, Op op = {}, const ParallelOptions& options = {}) {
+    if (v.empty())
+        return init;
+
+    ThreadPool& pool = detail::pool_of(options);
+    std::size_t grain = detail::grain_of(v.size(), options, pool);
+    std::size_t chunks = (v.size() + grain - 1) / grain;
+    ParallelOptions chunked = options;
+    chunked.grain = grain;
+
+    const T* data = v.data();
+    std::vector<std::optional<R>> partial(chunks);
+    detail::for_chunks(v.size(), chunked, [data, grain, &op, &partial](std::size_t first, std::size_t last) {
+        // a serial run covers all chunks at once
+        R acc = data[first];
+        for (std::size_t i = first + 1; i < last; ++i)
+            acc = op(std::move(acc), data[i]);
+        partial[first / grain] = std::move(acc);
+    });
+
+    R result = std::move(init);
+    for (auto& part : partial) {
+        if (part)
+            result = op(std::move(result), std::move(*part));
+    }
+    return result;
+}
+
+/**
+ * sort with `comp`, not stable.
+ * chunks are sorted in parallel, then merged pairwise with every merge of a round in parallel.
+ */
+template <typename T, typename Allocator, typename Growth, typename Compare = std::less<>>
+void parallel_sort(Vector<T, Allocator, Growth>& v, Compare comp = {}, const ParallelOptions& options = {}) {
+    T* data = v.data();
+    std::size_t n = v.size();
+    ThreadPool& pool = detail::pool_of(options);
+    if (n < options.serial_threshold || pool.size() < 2) {
+        std::sort(data, data + n, comp);
+        return;
+    }
+
+    std::size_t grain = detail::grain_of(n, options, pool);
+    ParallelOptions chunked = options;
+    chunked.grain = grain;
+    chunked.serial_threshold = 0;
+
+    detail::for_chunks(n, chunked, [data, &comp](std::size_t first, std::size_t last) {
+        std::sort(data + first, data + last, comp);
+    });
+
+    for (std::size_t width = grain; width < n; width *= 2) {
+        std::size_t merges = (n + 2 * width - 1) / (2 * width);
+        ParallelOptions round = chunked;
+        round.grain = 1;
+        detail::for_chunks(merges, round, [data, n, width, &comp](std::size_t first, std::size_t last) {
+            for (std::size_t m = first; m < last; ++m) {
+                std::size_t begin = m * 2 * width;
+                std::size_t middle = std::min(begin + width, n);
+                std::size_t end = std::min(begin + 2 * width, n);
+                std::inplace_merge(data + begin, data + middle, data + end, comp);
+            }
+        });
+    }
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * vector with O(1) copies that share their contents (structural sharing).
+ * elements are stored in a 32-way trie of leaves holding 32 elements each,
+ * plus a tail leaf that push_back appends to, as in Clojure's persistent vector.
+ *
+ * copying only copies the root and tail pointers. a write copies the nodes on
+ * its path that are shared with another copy and modifies unshared nodes in place,
+ * so a writer that keeps appending while snapshots exist copies O(log32 n) nodes per
+ * 32 pushes instead of the whole vector.
+ *
+ * different copies can be used from different threads at once. take the snapshot on
+ * the writer's thread (or under the writer's lock) and hand the copy to the readers.
+ */
+template <typename T>
+class PersistentVector {
+    class LeafCache;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = const value_type&;
+    using const_reference = const value_type&;
+    using iterator = detail::IndexIterator<PersistentVector, true, LeafCache>;
+    using const_iterator = iterator;
+
+    /**
+     * children per node and elements per leaf
+     */
+    static constexpr size_type branching = 32;
+
+    PersistentVector() = default;
+
+    PersistentVector(std::initializer_list<value_type> l) {
+        for (const auto& item : l)
+            push_back(item);
+    }
+
+    /**
+     * a copy sharing all nodes with this vector, same as copy construction
+     */
+    PersistentVector snapshot() const { return *this; }
+
+    size_type size() const noexcept { return _size; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    void push_back(const_reference value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template <typename... Args>
+    const_reference emplace_back(Args&&... args) {
+        if (_tail == nullptr || _size - tail_offset() == branching) {
+            // build the element first, so nothing changes if that throws
+            auto tail = std::make_shared<Leaf>();
+            tail->values.reserve(branching);
+            tail->values.emplace_back(std::forward<Args>(args)...);
+            if (_tail != nullptr)
+                push_tail();
+            _tail = std::move(tail);
+        } else {
+            own<Leaf>(_tail)->values.emplace_back(std::forward<Args>(args)...);
+        }
+        ++_size;
+        return back();
+    }
+
+    void pop_back() {
+        if (_size == 0)
+            throw std::out_of_range{"pop_back on empty PersistentVector"};
+
+        if (_size - tail_offset() > 1) {
+            own<Leaf>(_tail)->values.pop_back();
+        } else if (_size == 1) {
+            _tail = nullptr;
+        } else {
+            // the tail is used up, the last leaf of the trie becomes the new tail
+            std::shared_ptr<Node> new_tail = leaf_node(_size - 2);
+            _root = pop_tail(_shift, _root);
+            if (_shift > bits && _root != nullptr && branch(_root).children[1] == nullptr) {
+                _root = branch(_root).children[0];
+                _shift -= bits;
+            }
+            _tail = std::move(new_tail);
+        }
+        --_size;
+        if (_size <= branching) {
+            _root = nullptr;
+            _shift = bits;
+        }
+    }
+
+    /**
+     * replace the element at `index`, copies the shared nodes on its path
+     */
+    void set(size_type index, value_type value) {
+        if (index >= _size)
+            throw std::out_of_range{"Invalid position"};
+
+        if (index >= tail_offset()) {
+            own<Leaf>(_tail)->values[index - tail_offset()] = std::move(value);
+            return;
+        }
+        std::shared_ptr<Node>* slot = &_root;
+        for (size_type level = _shift; level > 0; level -= bits)
+            slot = &own<Branch>(*slot)->children[(index >> level) & mask];
+        own<Leaf>(*slot)->values[index & mask] = std::move(value);
+    }
+
+    void clear() noexcept {
+        _root = nullptr;
+        _tail = nullptr;
+        _size = 0;
+        _shift = bits;
+    }
+
+    /**
+     * with bounds check
+     */
+    const_reference at(size_type pos) const {
+        if (pos >= _size)
+            throw std::out_of_range{"Invalid position"};
+        return (*this)[pos];
+    }
+
+    /**
+     * without bounds check
+     */
+    const_reference operator[](size_type index) const noexcept {
+        return leaf_values(index)[index & mask];
+    }
+
+    const_reference back() const noexcept {
+        return (*this)[_size - 1];
+    }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    const_iterator end() const noexcept { return {this, _size}; }
+
+    const_iterator cend() const noexcept { return {this, _size}; }
+
+    /**
+     * stream a PersistentVector to an output stream textually
+     */
+    friend std::ostream& operator<<(std::ostream& o, const PersistentVector& v) {
+        o << "Size: " << v._size << std::endl;
+        for (size_type i = 0; i < v._size; ++i) {
+            if (i > 0)
+                o << ", ";
+            o << v[i];
+        }
+        o << std::endl;
+        return o;
+    }
+
+private:
+    static constexpr size_type bits = 5;
+    static constexpr size_type mask = branching - 1;
+
+    static_assert(size_type{1} << bits == branching);
+
+    /**
+     * nodes are shared_ptr<Node>, the depth tells whether one is a Branch or a Leaf
+     */
+    struct Node {};
+
+    struct Branch : Node {
+        std::array<std::shared_ptr<Node>, branching> children;
+    };
+
+    struct Leaf : Node {
+        Vector<T> values;
+    };
+
+    static Branch& branch(const std::shared_ptr<Node>& node) noexcept {
+        return static_cast<Branch&>(*node);
+    }
+
+    /**
+     * the node in `slot`, first copied if another vector shares it
+     */
+    template <typename N>
+    static N* own(std::shared_ptr<Node>& slot) {
+        if (slot.use_count() == 1) {
+            // pairs with the release when the last other owner dropped it
+            std::atomic_thread_fence(std::memory_order_acquire);
+        } else {
+            slot = std::make_shared<N>(static_cast<const N&>(*slot));
+        }
+        return static_cast<N*>(slot.get());
+    }
+
+    /**
+     * index of the first element in the tail
+     */
+    size_type tail_offset() const noexcept {
+        return _size < branching ? 0 : ((_size - 1) / branching) * branching;
+    }
+
+    const std::shared_ptr<Node>& leaf_node(size_type index) const noexcept {
+        if (index >= tail_offset())
+            return _tail;
+        const std::shared_ptr<Node>* node = &_root;
+        for (size_type level = _shift; level > 0; level -= bits)
+            node = &branch(*node).children[(index >> level) & mask];
+        return *node;
+    }
+
+    /**
+     * elements of the leaf holding `index`
+     */
+    const T* leaf_values(size_type index) const noexcept {
+        return static_cast<const Leaf&>(*leaf_node(index)).values.data();
+    }
+
+    /**
+     * chain of branches down to `leaf`, for a level that doesn't exist yet
+     */
+    static std::shared_ptr<Node> new_path(size_type level, std::shared_ptr<Node> leaf) {
+        if (level == 0)
+            return leaf;
+        auto node = std::make_shared<Branch>();
+        node->children[0] = new_path(level - bits, std::move(leaf));
+        return node;
+    }
+
+    /**
+     * move the full tail into the trie, before `_size` counts the next element
+     */
+    void push_tail() {
+        if (_root == nullptr) {
+            auto root = std::make_shared<Branch>();
+            root->children[0] = _tail;
+            _root = std::move(root);
+            _shift = bits;
+            return;
+        }
+        // a full trie grows a level at the top
+        if ((_size >> bits) > (size_type{1} << _shift)) {
+            auto root = std::make_shared<Branch>();
+            root->children[0] = _root;
+            root->children[1] = new_path(_shift, _tail);
+            _root = std::move(root);
+            _shift += bits;
+            return;
+        }
+        push_tail(_shift, _root);
+    }
+
+    void push_tail(size_type level, std::shared_ptr<Node>& slot) {
+        Branch* node = own<Branch>(slot);
+        size_type child = ((_size - 1) >> level) & mask;
+        if (level == bits)
+            node->children[child] = _tail;
+        else if (node->children[child] != nullptr)
+            push_tail(level - bits, node->children[child]);
+        else
+            node->children[child] = new_path(level - bits, _tail);
+    }
+
+    /**
+     * remove the last leaf below `slot`
+     * @return what `slot` holds afterwards, nullptr if nothing is left below it
+     */
+    std::shared_ptr<Node> pop_tail(size_type level, std::shared_ptr<Node>& slot) {
+        size_type child = ((_size - 2) >> level) & mask;
+        if (level == bits && child == 0)
+            return nullptr;
+
+        Branch* node = own<Branch>(slot);
+        if (level > bits) {
+            std::shared_ptr<Node> new_child = pop_tail(level - bits, node->children[child]);
+            if (new_child == nullptr && child == 0)
+                return nullptr;
+            node->children[child] = std::move(new_child);
+        } else {
+            node->children[child] = nullptr;
+        }
+        return slot;
+    }
+
+    size_type _size = 0;
+    size_type _shift = bits;
+    std::shared_ptr<Node> _root;
+    std::shared_ptr<Node> _tail;
+};
+
+
+/**
+ * remembers the leaf of the last element read, so stepping through a leaf doesn't walk the trie
+ */
+template <typename T>
+class PersistentVector<T>::LeafCache {
+public:
+    const T& operator()(const PersistentVector& vector, size_type index) const noexcept {
+        if (_leaf == nullptr || (index & ~mask) != _leaf_start) {
+            _leaf_start = index & ~mask;
+            _leaf = vector.leaf_values(index);
+        }
+        return _leaf[index & mask];
+    }
+
+private:
+    mutable const T* _leaf = nullptr;
+    mutable size_type _leaf_start = 0;
+};
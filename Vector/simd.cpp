@@ -0,0 +1,23 @@
+#include "simd.h"
+
+namespace simd {
+
+isa detected_isa() noexcept {
+#if defined(VECTOR_SIMD_X86)
+    static const isa detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return isa::avx2;
+        if (__builtin_cpu_supports("sse2"))
+            return isa::sse2;
+        return isa::scalar;
+    }();
+    return detected;
+#elif defined(VECTOR_SIMD_KERNELS)
+    return isa::sse2;
+#else
+    return isa::scalar;
+#endif
+}
+
+} // namespace simd
@@ -0,0 +1,421 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "allocator.h"
+#include "vector.h"
+
+/**
+ * Vector whose buffer starts on an `Align` byte boundary, so the kernels can use aligned loads
+ */
+template <typename T, std::size_t Align = 32>
+using AlignedVector = Vector<T, AlignedAllocator<T, Align>>;
+
+
+namespace simd {
+
+/**
+ * element types the kernels vectorize, other types use plain loops
+ */
+template <typename T>
+concept vectorizable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, long double>;
+
+enum class isa { scalar, sse2, avx2 };
+
+/**
+ * best instruction set supported by this CPU, detected once
+ */
+isa detected_isa() noexcept;
+
+
+namespace detail {
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMD_X86 1
+#endif
+
+#if defined(__GNUC__)
+#define VECTOR_SIMD_KERNELS 1
+#define VECTOR_SIMD_INLINE [[gnu::always_inline]] inline
+#endif
+
+#if defined(VECTOR_SIMD_KERNELS)
+
+/**
+ * `Bytes` wide register holding lanes of T.
+ * the helpers take registers by reference only: passed by value, 32 byte registers
+ * use a different calling convention inside and outside the AVX2 kernels.
+ */
+template <typename T, std::size_t Bytes>
+struct lanes {
+    typedef T vec __attribute__((vector_size(Bytes)));
+    using mask = decltype(vec{} == vec{});
+    static constexpr std::size_t count = Bytes / sizeof(T);
+};
+
+/**
+ * integer sums wrap, which is only defined for unsigned lanes
+ */
+template <typename T>
+using sum_type = typename std::conditional_t<std::is_integral_v<T>, std::make_unsigned<T>, std::type_identity<T>>::type;
+
+template <bool Aligned, typename V, typename T>
+VECTOR_SIMD_INLINE void load(V& v, const T* p) {
+    if constexpr (Aligned)
+        v = *reinterpret_cast<const V*>(p);
+    else
+        std::memcpy(&v, p, sizeof v);
+}
+
+template <typename V, typename T>
+VECTOR_SIMD_INLINE void store(T* p, const V& v) {
+    std::memcpy(p, &v, sizeof v);
+}
+
+template <typename Mask>
+VECTOR_SIMD_INLINE bool any(const Mask& m) {
+    std::uint64_t words[sizeof(Mask) / 8];
+    std::memcpy(words, &m, sizeof m);
+    std::uint64_t bits = 0;
+    for (auto word : words)
+        bits |= word;
+    return bits != 0;
+}
+
+
+template <typename T, std::size_t Bytes, bool Aligned>
+VECTOR_SIMD_INLINE T sum(const T* p, std::size_t n) {
+    using S = sum_type<T>;
+    using L = lanes<S, Bytes>;
+    auto* q = reinterpret_cast<const S*>(p);
+
+    // two accumulators hide the add latency
+    typename L::vec acc0{}, acc1{}, x, y;
+    std::size_t i = 0;
+    for (; i + 2 * L::count <= n; i += 2 * L::count) {
+        load<Aligned>(x, q + i);
+        load<Aligned>(y, q + i + L::count);
+        acc0 += x;
+        acc1 += y;
+    }
+    for (; i + L::count <= n; i += L::count) {
+        load<Aligned>(x, q + i);
+        acc0 += x;
+    }
+    acc0 += acc1;
+
+    S total{};
+    for (std::size_t k = 0; k < L::count; ++k)
+        total = static_cast<S>(total + acc0[k]);
+    for (; i < n; ++i)
+        total = static_cast<S>(total + q[i]);
+    return static_cast<T>(total);
+}
+
+template <typename T, std::size_t Bytes, bool Aligned, bool Max>
+VECTOR_SIMD_INLINE T extreme(const T* p, std::size_t n) {
+    using L = lanes<T, Bytes>;
+    std::size_t i = 0;
+    T result = p[0];
+    if (n >= L::count) {
+        typename L::vec best, x;
+        load<Aligned>(best, p);
+        for (i = L::count; i + L::count <= n; i += L::count) {
+            load<Aligned>(x, p + i);
+            if constexpr (Max)
+                best = x > best ? x : best;
+            else
+                best = x < best ? x : best;
+        }
+        for (std::size_t k = 0; k < L::count; ++k)
+            result = (Max ? best[k] > result : best[k] < result) ? static_cast<T>(best[k]) : result;
+    }
+    for (; i < n; ++i)
+        result = (Max ? p[i] > result : p[i] < result) ? p[i] : result;
+    return result;
+}
+
+template <typename T, std::size_t Bytes, bool Aligned>
+VECTOR_SIMD_INLINE std::size_t count(const T* p, std::size_t n, T value) {
+    using L = lanes<T, Bytes>;
+    // lanes of 8 bit masks overflow after 127 matches, flush well before that
+    constexpr std::size_t flush_every = 64;
+
+    const typename L::vec needle = value - typename L::vec{};
+    typename L::vec x;
+    std::size_t total = 0;
+    std::size_t i = 0;
+    while (i + L::count <= n) {
+        typename L::mask acc{};
+        for (std::size_t block = 0; block < flush_every && i + L::count <= n; ++block, i += L::count) {
+            load<Aligned>(x, p + i);
+            acc -= (x == needle);
+        }
+        for (std::size_t k = 0; k < L::count; ++k)
+            total += static_cast<std::size_t>(acc[k]);
+    }
+    for (; i < n; ++i)
+        total += (p[i] == value) ? 1 : 0;
+    return total;
+}
+
+template <typename T, std::size_t Bytes, bool Aligned>
+VECTOR_SIMD_INLINE std::size_t find(const T* p, std::size_t n, T value) {
+    using L = lanes<T, Bytes>;
+    const typename L::vec needle = value - typename L::vec{};
+    typename L::vec x;
+    std::size_t i = 0;
+    for (; i + L::count <= n; i += L::count) {
+        load<Aligned>(x, p + i);
+        if (any(x == needle))
+            break;
+    }
+    for (; i < n; ++i) {
+        if (p[i] == value)
+            return i;
+    }
+    return n;
+}
+
+/**
+ * one instantiation per register width; the 32 byte kernels are compiled for AVX2
+ */
+template <std::size_t Bytes>
+struct kernels {
+    template <typename T, bool Aligned>
+    static T sum(const T* p, std::size_t n) { return detail::sum<T, Bytes, Aligned>(p, n); }
+
+    template <typename T, bool Aligned, bool Max>
+    static T extreme(const T* p, std::size_t n) { return detail::extreme<T, Bytes, Aligned, Max>(p, n); }
+
+    template <typename T, bool Aligned>
+    static std::size_t count(const T* p, std::size_t n, T value) { return detail::count<T, Bytes, Aligned>(p, n, value); }
+
+    template <typename T, bool Aligned>
+    static std::size_t find(const T* p, std::size_t n, T value) { return detail::find<T, Bytes, Aligned>(p, n, value); }
+};
+
+#if defined(VECTOR_SIMD_X86)
+template <>
+struct kernels<32> {
+    template <typename T, bool Aligned>
+    [[gnu::target("avx2")]] static T sum(const T* p, std::size_t n) { return detail::sum<T, 32, Aligned>(p, n); }
+
+    template <typename T, bool Aligned, bool Max>
+    [[gnu::target("avx2")]] static T extreme(const T* p, std::size_t n) { return detail::extreme<T, 32, Aligned, Max>(p, n); }
+
+    template <typename T, bool Aligned>
+    [[gnu::target("avx2")]] static std::size_t count(const T* p, std::size_t n, T value) {
+        return detail::count<T, 32, Aligned>(p, n, value);
+    }
+
+    template <typename T, bool Aligned>
+    [[gnu::target("avx2")]] static std::size_t find(const T* p, std::size_t n, T value) {
+        return detail::find<T, 32, Aligned>(p, n, value);
+    }
+};
+#endif
+
+/**
+ * call `run(kernels<Bytes>, aligned)` with the widest registers this CPU has
+ * and whether `p` allows aligned loads of that width
+ */
+template <typename T, typename Run>
+decltype(auto) dispatch(const T* p, Run&& run) {
+    auto aligned_to = [p](std::size_t bytes) {
+        return reinterpret_cast<std::uintptr_t>(p) % bytes == 0;
+    };
+#if defined(VECTOR_SIMD_X86)
+    if (detected_isa() == isa::avx2)
+        return run(kernels<32>{}, aligned_to(32));
+#endif
+    return run(kernels<16>{}, aligned_to(16));
+}
+
+#endif // VECTOR_SIMD_KERNELS
+
+} // namespace detail
+
+
+/**
+ * sum of all elements, integers wrap like they do in a loop.
+ * floating point lanes are summed separately, so rounding can differ from a sequential loop.
+ */
+template <typename T, typename Allocator, typename Growth>
+T sum(const Vector<T, Allocator, Growth>& v) {
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T>) {
+        return detail::dispatch(v.data(), [&v](auto k, bool aligned) {
+            return aligned ? k.template sum<T, true>(v.data(), v.size()) : k.template sum<T, false>(v.data(), v.size());
+        });
+    }
+#endif
+    T total{};
+    for (const auto& item : v)
+        total = static_cast<T>(total + item);
+    return total;
+}
+
+/**
+ * smallest element, throws std::out_of_range for an empty Vector
+ */
+template <typename T, typename Allocator, typename Growth>
+T min(const Vector<T, Allocator, Growth>& v) {
+    if (v.empty())
+        throw std::out_of_range{"min of empty Vector"};
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T>) {
+        return detail::dispatch(v.data(), [&v](auto k, bool aligned) {
+            return aligned ? k.template extreme<T, true, false>(v.data(), v.size())
+                           : k.template extreme<T, false, false>(v.data(), v.size());
+        });
+    }
+#endif
+    T result = v[0];
+    for (const auto& item : v)
+        result = item < result ? item : result;
+    return result;
+}
+
+/**
+ * largest element, throws std::out_of_range for an empty Vector
+ */
+template <typename T, typename Allocator, typename Growth>
+T max(const Vector<T, Allocator, Growth>& v) {
+    if (v.empty())
+        throw std::out_of_range{"max of empty Vector"};
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T>) {
+        return detail::dispatch(v.data(), [&v](auto k, bool aligned) {
+            return aligned ? k.template extreme<T, true, true>(v.data(), v.size())
+                           : k.template extreme<T, false, true>(v.data(), v.size());
+        });
+    }
+#endif
+    T result = v[0];
+    for (const auto& item : v)
+        result = item > result ? item : result;
+    return result;
+}
+
+/**
+ * number of elements equal to `value`
+ */
+template <typename T, typename Allocator, typename Growth>
+std::size_t count(const Vector<T, Allocator, Growth>& v, T value) {
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T>) {
+        return detail::dispatch(v.data(), [&v, value](auto k, bool aligned) {
+            return aligned ? k.template count<T, true>(v.data(), v.size(), value)
+                           : k.template count<T, false>(v.data(), v.size(), value);
+        });
+    }
+#endif
+    std::size_t total = 0;
+    for (const auto& item : v)
+        total += (item == value) ? 1 : 0;
+    return total;
+}
+
+/**
+ * first element equal to `value`, `cend()` if there is none
+ */
+template <typename T, typename Allocator, typename Growth>
+typename Vector<T, Allocator, Growth>::const_iterator find(const Vector<T, Allocator, Growth>& v, T value) {
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T>) {
+        std::size_t index = detail::dispatch(v.data(), [&v, value](auto k, bool aligned) {
+            return aligned ? k.template find<T, true>(v.data(), v.size(), value)
+                           : k.template find<T, false>(v.data(), v.size(), value);
+        });
+        return v.cbegin() + index;
+    }
+#endif
+    auto it = v.cbegin();
+    while (it != v.cend() && !(*it == value))
+        ++it;
+    return it;
+}
+
+/**
+ * wraps an operation that also works on a register of lanes, e.g.
+ * `simd::lanewise{[](auto x) { return x * 2 + 1; }}`, so transform applies it 16 bytes at a time.
+ * arithmetic, shifts and bit operations work lane by lane, calls like std::abs and
+ * branches on the value don't: leave those unwrapped and they run element by element.
+ * whether an operation works on registers can't be probed, the return type of a generic
+ * lambda is only checked when its body is instantiated.
+ */
+template <typename Op>
+struct lanewise {
+    Op op;
+};
+
+template <typename Op>
+lanewise(Op) -> lanewise<Op>;
+
+
+namespace detail {
+
+template <typename Op>
+struct lanewise_traits {
+    static constexpr bool vectorized = false;
+
+    static Op& unwrap(Op& op) noexcept { return op; }
+};
+
+template <typename Op>
+struct lanewise_traits<lanewise<Op>> {
+    static constexpr bool vectorized = true;
+
+    static Op& unwrap(lanewise<Op>& wrapped) noexcept { return wrapped.op; }
+};
+
+} // namespace detail
+
+
+/**
+ * out[i] = op(in[i]) for every element of `in`, `out` needs at least as many elements.
+ * an `op` wrapped in simd::lanewise is applied to 16 bytes at a time. it runs in the
+ * caller's instruction set, wider registers can't be handed to user code from a
+ * runtime dispatched kernel.
+ */
+template <typename T, typename InAllocator, typename InGrowth, typename OutAllocator, typename OutGrowth,
+          typename Op>
+void transform(const Vector<T, InAllocator, InGrowth>& in, Vector<T, OutAllocator, OutGrowth>& out, Op op) {
+    if (out.size() < in.size())
+        throw std::out_of_range{"transform target too small"};
+
+    const T* src = in.data();
+    T* dst = out.data();
+    std::size_t n = in.size();
+    std::size_t i = 0;
+    auto& f = detail::lanewise_traits<Op>::unwrap(op);
+#if defined(VECTOR_SIMD_KERNELS)
+    if constexpr (vectorizable<T> && detail::lanewise_traits<Op>::vectorized) {
+        using L = detail::lanes<T, 16>;
+        static_assert(std::is_invocable_r_v<typename L::vec, decltype(f), typename L::vec>,
+                      "a lanewise operation has to accept and return a register of lanes");
+        for (; i + L::count <= n; i += L::count) {
+            typename L::vec x;
+            detail::load<false>(x, src + i);
+            detail::store(dst + i, f(x));
+        }
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = static_cast<T>(f(src[i]));
+}
+
+/**
+ * v[i] = op(v[i]) for every element
+ */
+template <typename T, typename Allocator, typename Growth, typename Op>
+void transform(Vector<T, Allocator, Growth>& v, Op op) {
+    transform(v, v, op);
+}
+
+} // namespace simd
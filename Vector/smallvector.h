@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * Vector with room for `N` elements inside the object,
+ * only allocates from `Allocator` once it grows beyond that.
+ * `Growth` works like Vector's, it only sees heap buffers.
+ */
+template <typename T, std::size_t N, typename Allocator = std::allocator<T>, typename Growth = growth::Double>
+class SmallVector : public detail::ContiguousAccess<SmallVector<T, N, Allocator, Growth>, T> {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using elements = detail::Elements<Allocator>;
+
+public:
+    /**
+     *  associated types
+     */
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_assert(N > 0, "use Vector without inline storage");
+    static_assert(std::is_same_v<typename alloc_traits::value_type, value_type>,
+                  "allocator has to allocate value_type");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, pointer>,
+                  "fancy allocator pointers are not supported");
+    static_assert(growth::policy<Growth>, "Growth has to be a growth policy");
+
+    /**
+     * number of elements stored without allocating
+     */
+    static constexpr size_type inline_capacity = N;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const allocator_type& alloc) noexcept : _alloc(alloc) {}
+
+
+    /**
+     * the constructors that build elements delegate to SmallVector(alloc) first,
+     * so the destructor cleans up if an element constructor throws
+     */
+    SmallVector(size_type n, const_reference default_val, const allocator_type& alloc = allocator_type())
+        : SmallVector(alloc) {
+        reserve(n);
+        for (; _size < n; ++_size)
+            construct(_data + _size, default_val);
+    }
+
+
+    SmallVector(std::initializer_list<value_type> l, const allocator_type& alloc = allocator_type())
+        : SmallVector(alloc) {
+        reserve(l.size());
+        for (const auto& item : l) {
+            construct(_data + _size, item);
+            ++_size;
+        }
+    }
+
+    SmallVector(const SmallVector& copy)
+        : SmallVector(copy, alloc_traits::select_on_container_copy_construction(copy._alloc)) {}
+
+    SmallVector(const SmallVector& copy, const allocator_type& alloc) : SmallVector(alloc) {
+        reserve(copy._size);
+        for (const auto& item : copy) {
+            construct(_data + _size, item);
+            ++_size;
+        }
+    }
+
+    /**
+     * takes over the heap buffer, inline elements are moved one by one
+     */
+    SmallVector(SmallVector&& move) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+        : _alloc(std::move(move._alloc)) {
+        take(move);
+    }
+
+    /**
+     * copy assignment
+     */
+    SmallVector& operator=(const SmallVector& copy) {
+        if (this != &copy) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                if (_alloc != copy._alloc)
+                    release();
+                _alloc = copy._alloc;
+            }
+            clear();
+            reserve(copy._size);
+            for (const auto& item : copy) {
+                construct(_data + _size, item);
+                ++_size;
+            }
+        }
+        return *this;
+    }
+
+
+    /**
+     * move assignment
+     */
+    SmallVector& operator=(SmallVector&& move) noexcept(std::is_nothrow_move_constructible_v<value_type> &&
+                                                        (alloc_traits::propagate_on_container_move_assignment::value ||
+                                                         alloc_traits::is_always_equal::value)) {
+        if (this == &move)
+            return *this;
+
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            release();
+            _alloc = std::move(move._alloc);
+            take(move);
+        } else {
+            if (_alloc == move._alloc) {
+                release();
+                take(move);
+            } else {
+                clear();
+                reserve(move._size);
+                for (auto& item : move) {
+                    construct(_data + _size, std::move(item));
+                    ++_size;
+                }
+                move.clear();
+            }
+        }
+        return *this;
+    }
+
+    void swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<SmallVector> &&
+                                           std::is_nothrow_move_assignable_v<SmallVector>) {
+        SmallVector tmp{std::move(other)};
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    allocator_type get_allocator() const noexcept { return _alloc; }
+
+    size_type size() const noexcept { return _size; }
+
+    size_type capacity() const noexcept { return _capacity; }
+
+    bool empty() const noexcept { return _size == 0; }
+
+    /**
+     * true while the elements live inside the object
+     */
+    bool is_inline() const noexcept { return _data == inline_data(); }
+
+    pointer data() noexcept { return _data; }
+
+    const_pointer data() const noexcept { return _data; }
+
+    /**
+     * make room for at least `new_capacity` elements, grows at most once
+     */
+    void reserve(size_type new_capacity) {
+        if (new_capacity > _capacity)
+            reallocate(new_capacity);
+    }
+
+    /**
+     * give back unused heap capacity, moves back inline if the elements fit
+     */
+    void shrink_to_fit() {
+        if (!is_inline() && _capacity > _size)
+            reallocate(_size);
+    }
+
+    void push_back(const_reference value) {
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * construct a new last element in place
+     */
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (_size < _capacity) {
+            construct(_data + _size, std::forward<Args>(args)...);
+            return _data[_size++];
+        }
+
+        // the arguments may refer to an element of this vector,
+        // so construct the new element before the old ones are moved away
+        size_type new_capacity = calculate_capacity(_size + 1);
+        pointer new_data = allocate(new_capacity);
+        try {
+            construct(new_data + _size, std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        try {
+            relocate(_data, _size, new_data);
+        } catch (...) {
+            destroy(new_data + _size, 1);
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        if constexpr (instrumented)
+            Growth::telemetry().record_growth(_size * sizeof(value_type));
+        free_heap();
+        _data = new_data;
+        _capacity = new_capacity;
+        return _data[_size++];
+    }
+
+    void pop_back() {
+        alloc_traits::destroy(_alloc, _data + --_size);
+    }
+
+    /**
+     * destroy all elements, the capacity is kept
+     */
+    void clear() noexcept {
+        destroy(_data, _size);
+        _size = 0;
+    }
+
+    /**
+     * insert [first, last) before `pos`, reallocates at most once
+     * @return iterator to the first inserted element
+     */
+    template <std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        auto offset = static_cast<size_type>(pos - this->cbegin());
+        size_type old_size = _size;
+
+        if constexpr (std::forward_iterator<InputIt>)
+            reserve(calculate_capacity(_size + static_cast<size_type>(std::distance(first, last))));
+
+        // append, then rotate into place
+        for (; first != last; ++first)
+            emplace_back(*first);
+        std::rotate(this->begin() + offset, this->begin() + old_size, this->end());
+        return this->begin() + offset;
+    }
+
+    /**
+     * append [first, last), reallocates at most once
+     */
+    template <std::input_iterator InputIt>
+    void append(InputIt first, InputIt last) {
+        insert(this->cend(), first, last);
+    }
+
+    ~SmallVector() {
+        release();
+    }
+
+private:
+
+    static constexpr bool instrumented = growth::instrumented<Growth>;
+
+    size_type _size = 0;
+    size_type _capacity = N;
+
+    /**
+     * points to `_inline` or to a heap buffer,
+     * only the first `_size` slots hold constructed elements
+     */
+    pointer _data = inline_data();
+
+    [[no_unique_address]] allocator_type _alloc = allocator_type();
+
+    alignas(value_type) std::byte _inline[N * sizeof(value_type)];
+
+    pointer inline_data() noexcept {
+        return reinterpret_cast<pointer>(_inline);
+    }
+
+    const_pointer inline_data() const noexcept {
+        return reinterpret_cast<const_pointer>(_inline);
+    }
+
+    pointer allocate(size_type n) {
+        pointer p = alloc_traits::allocate(_alloc, n);
+        if constexpr (instrumented)
+            Growth::telemetry().record_allocation(n * sizeof(value_type));
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n) noexcept {
+        alloc_traits::deallocate(_alloc, p, n);
+        if constexpr (instrumented)
+            Growth::telemetry().record_deallocation(n * sizeof(value_type));
+    }
+
+    template <typename... Args>
+    void construct(pointer p, Args&&... args) {
+        elements::construct(_alloc, p, std::forward<Args>(args)...);
+    }
+
+    void destroy(pointer first, size_type n) noexcept {
+        elements::destroy(_alloc, first, n);
+    }
+
+    /**
+     * see detail::Elements, if it throws nothing was built at `dst` and the originals are intact
+     */
+    void relocate(pointer src, size_type n, pointer dst) {
+        elements::relocate(_alloc, src, n, dst);
+    }
+
+    void free_heap() noexcept {
+        if (!is_inline())
+            deallocate(_data, _capacity);
+    }
+
+    void release() noexcept {
+        if constexpr (instrumented) {
+            if (!is_inline())
+                Growth::telemetry().record_release((_capacity - _size) * sizeof(value_type));
+        }
+        destroy(_data, _size);
+        free_heap();
+        _data = inline_data();
+        _size = 0;
+        _capacity = N;
+    }
+
+    /**
+     * move the elements of `other` into this empty, inline vector:
+     * a heap buffer is stolen, inline elements are moved one by one. `other` is left empty.
+     */
+    void take(SmallVector& other) {
+        if (other.is_inline()) {
+            relocate(other._data, other._size, _data);
+            _size = std::exchange(other._size, 0);
+        } else {
+            _data = std::exchange(other._data, other.inline_data());
+            _size = std::exchange(other._size, 0);
+            _capacity = std::exchange(other._capacity, N);
+        }
+    }
+
+    size_type calculate_capacity(size_type new_size) const {
+        if(new_size <= _capacity)
+            return _capacity;
+        return Growth::next(_capacity, new_size, sizeof(value_type));
+    }
+
+    /**
+     * move all elements into a buffer of `new_capacity` slots, the inline one if they fit
+     */
+    void reallocate(size_type new_capacity) {
+        if (new_capacity <= N) {
+            if (is_inline())
+                return;
+            pointer heap = _data;
+            size_type heap_capacity = _capacity;
+            relocate(heap, _size, inline_data());
+            deallocate(heap, heap_capacity);
+            _data = inline_data();
+            _capacity = N;
+            return;
+        }
+
+        pointer new_data = allocate(new_capacity);
+        try {
+            relocate(_data, _size, new_data);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        if constexpr (instrumented)
+            Growth::telemetry().record_growth(_size * sizeof(value_type));
+        free_heap();
+        _data = new_data;
+        _capacity = new_capacity;
+    }
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+template <bool Const, typename... Fields>
+class SoARow;
+
+
+/**
+ * records stored as one contiguous Vector per field (struct of arrays).
+ * a scan over one field only touches that field's memory, and a column is a plain
+ * Vector, so the SIMD kernels work on it directly.
+ * all columns always have the same size and grow together.
+ *
+ * rows are proxies: `soa[i]` and dereferenced iterators hand out an SoARow
+ * that refers to the i-th element of every column, so
+ * `for (auto [id, price] : soa)` iterates the columns zipped.
+ */
+template <typename... Fields>
+class SoAVector {
+public:
+    /**
+     *  associated types
+     */
+    using value_type = std::tuple<Fields...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = SoARow<false, Fields...>;
+    using const_reference = SoARow<true, Fields...>;
+    using iterator = detail::IndexIterator<SoAVector, false>;
+    using const_iterator = detail::IndexIterator<SoAVector, true>;
+
+    /**
+     * type of the column `I`
+     */
+    template <std::size_t I>
+    using field_type = std::tuple_element_t<I, value_type>;
+
+    static_assert(sizeof...(Fields) > 0, "a record needs at least one field");
+
+    static constexpr std::size_t field_count = sizeof...(Fields);
+
+    SoAVector() = default;
+
+    SoAVector(std::initializer_list<value_type> l) {
+        reserve(l.size());
+        for (const auto& row : l)
+            push_back(row);
+    }
+
+    size_type size() const noexcept { return std::get<0>(_columns).size(); }
+
+    size_type capacity() const noexcept { return std::get<0>(_columns).capacity(); }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * the contiguous Vector holding field `I` of every row
+     */
+    template <std::size_t I>
+    const Vector<field_type<I>>& column() const noexcept {
+        return std::get<I>(_columns);
+    }
+
+    /**
+     * first element of column `I`, for writing a column in bulk
+     */
+    template <std::size_t I>
+    field_type<I>* data() noexcept {
+        return std::get<I>(_columns).data();
+    }
+
+    template <std::size_t I>
+    const field_type<I>* data() const noexcept {
+        return std::get<I>(_columns).data();
+    }
+
+    /**
+     * make room for at least `new_capacity` rows in every column
+     */
+    void reserve(size_type new_capacity) {
+        std::apply([new_capacity](auto&... column) { (column.reserve(new_capacity), ...); }, _columns);
+    }
+
+    void shrink_to_fit() {
+        std::apply([](auto&... column) { (column.shrink_to_fit(), ...); }, _columns);
+    }
+
+    /**
+     * append a row, one value per field.
+     * if a column throws, the columns already appended to are rolled back.
+     */
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == field_count, "one value per field");
+        append<0>(std::forward_as_tuple(std::forward<Args>(args)...));
+        return (*this)[size() - 1];
+    }
+
+    void push_back(const value_type& row) {
+        std::apply([this](const auto&... values) { emplace_back(values...); }, row);
+    }
+
+    void push_back(value_type&& row) {
+        std::apply([this](auto&&... values) { emplace_back(std::move(values)...); }, std::move(row));
+    }
+
+    void pop_back() {
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, _columns);
+    }
+
+    /**
+     * destroy all rows, the capacity is kept
+     */
+    void clear() noexcept {
+        std::apply([](auto&... column) { (column.clear(), ...); }, _columns);
+    }
+
+    /**
+     * with bounds check
+     */
+    reference at(size_type pos) {
+        if (pos >= size())
+            throw std::out_of_range{"Invalid position"};
+        return (*this)[pos];
+    }
+
+    const_reference at(size_type pos) const {
+        if (pos >= size())
+            throw std::out_of_range{"Invalid position"};
+        return (*this)[pos];
+    }
+
+    /**
+     * without bounds check
+     */
+    reference operator[](size_type index) noexcept { return {&_columns, index}; }
+
+    const_reference operator[](size_type index) const noexcept { return {&_columns, index}; }
+
+    iterator begin() noexcept { return {this, 0}; }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator cbegin() const noexcept { return {this, 0}; }
+
+    iterator end() noexcept { return {this, size()}; }
+
+    const_iterator end() const noexcept { return {this, size()}; }
+
+    const_iterator cend() const noexcept { return {this, size()}; }
+
+private:
+    using columns_type = std::tuple<Vector<Fields>...>;
+
+    /**
+     * append `std::get<I>(values)` to column `I` and the rest after it,
+     * pops column `I` again if a later one throws
+     */
+    template <std::size_t I, typename Values>
+    void append(Values&& values) {
+        if constexpr (I < field_count) {
+            std::get<I>(_columns).emplace_back(std::forward<std::tuple_element_t<I, std::remove_reference_t<Values>>>(
+                std::get<I>(values)));
+            try {
+                append<I + 1>(std::forward<Values>(values));
+            } catch (...) {
+                std::get<I>(_columns).pop_back();
+                throw;
+            }
+        }
+    }
+
+    columns_type _columns;
+};
+
+
+/**
+ * proxy for one row of an SoAVector, refers to the row's element in each column.
+ * copying a row copies the reference, not the values - convert it to the
+ * SoAVector's value_type (a std::tuple) for that.
+ */
+template <bool Const, typename... Fields>
+class SoARow {
+    using columns_type = std::conditional_t<Const, const std::tuple<Vector<Fields>...>, std::tuple<Vector<Fields>...>>;
+
+public:
+    using value_type = std::tuple<Fields...>;
+
+    SoARow(columns_type* columns, std::size_t index) noexcept : _columns{columns}, _index{index} {}
+
+    operator SoARow<true, Fields...>() const noexcept { return {_columns, _index}; }
+
+    /**
+     * field `I` of this row
+     */
+    template <std::size_t I>
+    auto& get() const noexcept {
+        return std::get<I>(*_columns)[_index];
+    }
+
+    /**
+     * copy of the row's values
+     */
+    operator value_type() const {
+        return values(std::index_sequence_for<Fields...>{});
+    }
+
+    /**
+     * overwrite the row's values, the proxy itself keeps referring to the same row
+     */
+    const SoARow& operator=(const value_type& row) const requires(!Const) {
+        assign(row, std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+
+    const SoARow& operator=(const SoARow& other) const requires(!Const) {
+        return *this = static_cast<value_type>(other);
+    }
+
+    std::size_t index() const noexcept { return _index; }
+
+    friend bool operator==(const SoARow& a, const SoARow& b) {
+        return static_cast<value_type>(a) == static_cast<value_type>(b);
+    }
+
+    /**
+     * for structured bindings
+     */
+    template <std::size_t I>
+    friend auto& get(const SoARow& row) noexcept {
+        return row.template get<I>();
+    }
+
+private:
+    template <std::size_t... I>
+    value_type values(std::index_sequence<I...>) const {
+        return value_type{get<I>()...};
+    }
+
+    template <std::size_t... I>
+    void assign(const value_type& row, std::index_sequence<I...>) const {
+        ((get<I>() = std::get<I>(row)), ...);
+    }
+
+    columns_type* _columns;
+    std::size_t _index;
+};
+
+
+template <bool Const, typename... Fields>
+struct std::tuple_size<SoARow<Const, Fields...>> : std::integral_constant<std::size_t, sizeof...(Fields)> {};
+
+template <std::size_t I, bool Const, typename... Fields>
+struct std::tuple_element<I, SoARow<Const, Fields...>> {
+    using type = std::conditional_t<Const, const std::tuple_element_t<I, std::tuple<Fields...>>,
+                                    std::tuple_element_t<I, std::tuple<Fields...>>>&;
+};
@@ -0,0 +1,312 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * a type is trivially relocatable if moving it to a new address and forgetting the old
+ * object is the same as copying its bytes. true for trivially copyable types,
+ * specialize it for others that qualify (e.g. types holding a unique_ptr).
+ */
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+
+namespace detail {
+
+/**
+ * element lifetime in raw storage through an allocator, shared by the contiguous containers
+ */
+template <typename Allocator>
+struct Elements {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using value_type = typename alloc_traits::value_type;
+    using pointer = value_type*;
+    using size_type = std::size_t;
+
+    template <typename... Args>
+    static void construct(Allocator& alloc, pointer p, Args&&... args) {
+        alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+    }
+
+    static void destroy(Allocator& alloc, pointer first, size_type n) noexcept {
+        for (size_type i = 0; i < n; ++i)
+            alloc_traits::destroy(alloc, first + i);
+    }
+
+    /**
+     * construct `count` elements from `first` in raw storage, all or nothing
+     */
+    template <typename ForwardIt>
+    static void construct_range(Allocator& alloc, pointer dst, ForwardIt first, size_type count) {
+        size_type done = 0;
+        try {
+            for (; done < count; ++done, ++first)
+                construct(alloc, dst + done, *first);
+        } catch (...) {
+            destroy(alloc, dst, done);
+            throw;
+        }
+    }
+
+    /**
+     * move-construct `n` elements from `src` into raw storage at `dst`, all or nothing.
+     * copies instead when moving could throw and copying is possible, so the originals
+     * are intact if it throws. they still have to be discarded afterwards.
+     */
+    static void transfer(Allocator& alloc, pointer src, size_type n, pointer dst) {
+        if constexpr (is_trivially_relocatable_v<value_type>) {
+            if (n != 0)
+                std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+        } else if constexpr (std::is_nothrow_move_constructible_v<value_type>) {
+            for (size_type i = 0; i < n; ++i)
+                construct(alloc, dst + i, std::move(src[i]));
+        } else if constexpr (!std::is_copy_constructible_v<value_type>) {
+            construct_range(alloc, dst, std::make_move_iterator(src), n);
+        } else {
+            construct_range(alloc, dst, src, n);
+        }
+    }
+
+    /**
+     * end the originals after a transfer, trivially relocatable ones now live at the
+     * destination as bytes and are not destroyed
+     */
+    static void discard(Allocator& alloc, pointer src, size_type n) noexcept {
+        if constexpr (!is_trivially_relocatable_v<value_type>)
+            destroy(alloc, src, n);
+    }
+
+    /**
+     * move `n` elements from `src` to raw storage at `dst`, the originals end.
+     * if it throws, nothing was built at `dst` and the originals are intact.
+     */
+    static void relocate(Allocator& alloc, pointer src, size_type n, pointer dst) {
+        transfer(alloc, src, n, dst);
+        discard(alloc, src, n);
+    }
+};
+
+
+/**
+ * element access, iterators and printing for containers keeping their elements
+ * in one array, `Derived` provides data(), size() and capacity()
+ */
+template <typename Derived, typename T>
+class ContiguousAccess {
+public:
+    /**
+     * with bounds check
+     */
+    const T& at(const std::size_t pos) const {
+        if(pos < self().size()){
+            return self().data()[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    T& at(const std::size_t pos) {
+        if(pos < self().size()){
+            return self().data()[pos];
+        }else{
+            throw std::out_of_range{"Invalid position"};
+        }
+    }
+
+    /**
+     * without bounds check
+     */
+    const T& operator[](std::size_t index) const {
+        return self().data()[index];
+    }
+
+    T& operator[](const std::size_t index) {
+        return self().data()[index];
+    }
+
+
+    T* begin() {
+        return self().data();
+    }
+
+    const T* begin() const {
+        return self().data();
+    }
+
+    const T* cbegin() const {
+        return self().data();
+    }
+
+    T* end() {
+        return self().data() + self().size();
+    }
+
+    const T* end() const {
+        return self().data() + self().size();
+    }
+
+    const T* cend() const {
+        return self().data() + self().size();
+    }
+
+    std::reverse_iterator<T*> rbegin() {
+        return std::reverse_iterator<T*>{end()};
+    }
+
+    std::reverse_iterator<const T*> rbegin() const {
+        return std::reverse_iterator<const T*>{end()};
+    }
+
+    std::reverse_iterator<const T*> crbegin() const {
+        return std::reverse_iterator<const T*>{cend()};
+    }
+
+    std::reverse_iterator<T*> rend() {
+        return std::reverse_iterator<T*>{begin()};
+    }
+
+    std::reverse_iterator<const T*> rend() const {
+        return std::reverse_iterator<const T*>{begin()};
+    }
+
+    std::reverse_iterator<const T*> crend() const {
+        return std::reverse_iterator<const T*>{cbegin()};
+    }
+
+    /**
+     * stream the container to an output stream textually
+     */
+    friend std::ostream& operator<<(std::ostream& o, const Derived& v) {
+        o << "Size: " << v.size() << ", Capacity: " << v.capacity() << std::endl;
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            if (i > 0)
+                o << ", ";
+            o << v[i];
+        }
+        o << std::endl;
+        return o;
+    }
+
+private:
+    Derived& self() noexcept {
+        return static_cast<Derived&>(*this);
+    }
+
+    const Derived& self() const noexcept {
+        return static_cast<const Derived&>(*this);
+    }
+};
+
+
+/**
+ * the default element access of IndexIterator
+ */
+struct Subscript {
+    template <typename Owner>
+    decltype(auto) operator()(Owner& container, std::size_t index) const {
+        return container[index];
+    }
+};
+
+
+/**
+ * random access iterator over a container that is indexed with operator[] but doesn't
+ * keep its elements in one array. it holds the container and an index, so it stays valid
+ * while the container grows as long as the element does. dereferencing gives whatever
+ * operator[] gives, for a proxy or a value the iterator is only an input iterator to the
+ * standard library.
+ * every iterator has its own `Reader`, which reads an element and may cache where it was found.
+ */
+template <typename Owner, bool Const, typename Reader = Subscript>
+class IndexIterator {
+    using owner = std::conditional_t<Const, const Owner, Owner>;
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = typename Owner::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = decltype(std::declval<const Reader&>()(std::declval<owner&>(), std::size_t{}));
+    using iterator_category = std::conditional_t<std::is_lvalue_reference_v<reference>,
+                                                 std::random_access_iterator_tag, std::input_iterator_tag>;
+
+    IndexIterator() = default;
+
+    IndexIterator(owner* container, std::size_t index) noexcept : _owner{container}, _index{index} {}
+
+    operator IndexIterator<Owner, true, Reader>() const noexcept
+        requires (!Const)
+    {
+        return {_owner, _index};
+    }
+
+    reference operator*() const noexcept { return _read(*_owner, _index); }
+
+    auto operator->() const noexcept
+        requires std::is_lvalue_reference_v<reference>
+    {
+        return std::addressof(_read(*_owner, _index));
+    }
+
+    reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    IndexIterator& operator++() noexcept {
+        ++_index;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        IndexIterator old = *this;
+        ++_index;
+        return old;
+    }
+
+    IndexIterator& operator--() noexcept {
+        --_index;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        IndexIterator old = *this;
+        --_index;
+        return old;
+    }
+
+    IndexIterator& operator+=(difference_type n) noexcept {
+        _index = static_cast<std::size_t>(static_cast<difference_type>(_index) + n);
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type n) noexcept { return *this += -n; }
+
+    friend IndexIterator operator+(IndexIterator it, difference_type n) noexcept { return it += n; }
+
+    friend IndexIterator operator+(difference_type n, IndexIterator it) noexcept { return it += n; }
+
+    friend IndexIterator operator-(IndexIterator it, difference_type n) noexcept { return it -= n; }
+
+    friend difference_type operator-(const IndexIterator& a, const IndexIterator& b) noexcept {
+        return static_cast<difference_type>(a._index) - static_cast<difference_type>(b._index);
+    }
+
+    friend bool operator==(const IndexIterator& a, const IndexIterator& b) noexcept { return a._index == b._index; }
+
+    friend auto operator<=>(const IndexIterator& a, const IndexIterator& b) noexcept { return a._index <=> b._index; }
+
+private:
+    owner* _owner = nullptr;
+    std::size_t _index = 0;
+    [[no_unique_address]] Reader _read;
+};
+
+} // namespace detail
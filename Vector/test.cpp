@@ -1,7 +1,39 @@
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "allocator.h"
+#include "concurrentvector.h"
+#include "incrementalvector.h"
+#include "mappedvector.h"
+#include "packedvector.h"
+#include "parallel.h"
+#include "persistentvector.h"
+#include "simd.h"
+#include "smallvector.h"
+#include "soavector.h"
 #include "vector.h"
 
 
+// tag of the instrumented Vector below
+struct GrowthDemo {
+    static constexpr const char* name = "test.growth";
+};
+
+// has no default constructor
+struct Point {
+    Point(int x, int y) : x{x}, y{y} {}
+    int x;
+    int y;
+};
+
+std::ostream& operator<<(std::ostream& o, const Point& p) {
+    return o << "(" << p.x << "|" << p.y << ")";
+}
+
+
 int main() {
     size_t count{14};
     Vector<int> v(count, 2);
@@ -44,5 +76,176 @@ int main() {
     Vector<std::string> v3 {"Best Editors", "Emacs", "Emacs", "Emacs", "emacs"};
     std::cout << v3 << std::endl;
 
+    Vector<std::string> v4;
+    v4.reserve(4);
+    v4.emplace_back(3, 'x');
+    v4.emplace_back("tail");
+    std::string middle[] = {"one", "two", "three"};
+    v4.insert(v4.cbegin() + 1, std::begin(middle), std::end(middle));
+    v4.append(v3.cbegin(), v3.cbegin() + 2);
+    std::cout << v4 << std::endl;
+    v4.shrink_to_fit();
+    std::cout << "Capacity after shrink_to_fit: " << v4.capacity() << std::endl;
+
+    Vector<Point> v5;
+    for (int i = 0; i < 5; ++i)
+        v5.emplace_back(i, i * i);
+    v5.pop_back();
+    std::cout << v5 << std::endl;
+
+    // request scoped vectors, everything is freed when the arena goes away
+    MonotonicArena arena;
+    pmr::Vector<int> v6{&arena};
+    v6.reserve(16);
+    for (int i = 0; i < 16; ++i)
+        v6.push_back(i * 3);
+    pmr::Vector<std::pmr::string> v7{&arena};
+    v7.emplace_back("strings in the arena too");
+    std::cout << "Arena: " << v6[15] << ", " << v7[0] << ", reserved bytes: " << arena.reserved_bytes() << std::endl;
+
+    SizeClassPool pool;
+    for (int round = 0; round < 3; ++round) {
+        pmr::Vector<long> small{&pool};
+        for (long i = 0; i < 6; ++i)
+            small.push_back(i);
+        std::cout << "Pool round " << round << ": " << small.size() << " elements" << std::endl;
+    }
+
+    SmallVector<std::string, 4> v8{"inline", "storage"};
+    std::cout << v8 << "inline: " << v8.is_inline() << std::endl;
+    for (int i = 0; i < 4; ++i)
+        v8.push_back(std::to_string(i));
+    SmallVector<std::string, 4> v9 = std::move(v8);
+    std::cout << v9 << "inline: " << v9.is_inline() << std::endl;
+    while (v9.size() > 3)
+        v9.pop_back();
+    v9.shrink_to_fit();
+    std::cout << v9 << "inline: " << v9.is_inline() << std::endl;
+
+    // grows with realloc, then mremap once past the mmap threshold
+    Vector<std::int64_t, MappedAllocator<std::int64_t>> v10;
+    for (std::int64_t i = 0; i < (1 << 22); ++i)
+        v10.push_back(i);
+    std::cout << "Mapped: " << v10.size() << " elements, last " << v10[v10.size() - 1] << std::endl;
+
+    AlignedVector<float> v11;
+    for (int i = 0; i < 1000; ++i)
+        v11.push_back(static_cast<float>(i % 17));
+    simd::transform(v11, simd::lanewise{[](auto x) { return x * 2 + 1; }});
+    std::cout << "SIMD: sum " << simd::sum(v11) << ", min " << simd::min(v11) << ", max " << simd::max(v11)
+              << ", count(33) " << simd::count(v11, 33.0f) << ", find(9) at " << simd::find(v11, 9.0f) - v11.cbegin()
+              << std::endl;
+
+    ThreadPool workers{4};
+    ParallelOptions options{.grain = 1 << 14, .pool = &workers};
+    Vector<std::int64_t> v12;
+    for (std::int64_t i = 0; i < 100000; ++i)
+        v12.push_back((i * 7919) % 100000);
+    parallel_sort(v12, std::less<>{}, options);
+    parallel_for_each(v12, [](std::int64_t& x) { x *= 2; }, options);
+    std::cout << "Parallel: first " << v12[0] << ", last " << v12[v12.size() - 1]
+              << ", sum " << parallel_reduce(v12, std::int64_t{0}, std::plus<>{}, options) << std::endl;
+
+    // producers append without a lock, elements never move
+    ConcurrentVector<std::string> v13;
+    Vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t)
+        producers.emplace_back([&v13, t] {
+            for (int i = 0; i < 1000; ++i)
+                v13.push_back("producer " + std::to_string(t));
+        });
+    for (auto& producer : producers)
+        producer.join();
+    std::size_t from_first = 0;
+    for (const auto& item : v13)
+        from_first += item == "producer 0" ? 1 : 0;
+    std::cout << "Concurrent: " << v13.size() << " elements, " << from_first << " from producer 0" << std::endl;
+
+    // one column per field, scans only touch the columns they read
+    SoAVector<int, double, std::string> v14;
+    for (int i = 0; i < 5; ++i)
+        v14.emplace_back(i, i * 1.5, "item " + std::to_string(i));
+    for (auto [id, price, name] : v14)
+        price += id;
+    std::cout << "SoA: " << v14.size() << " rows, price sum " << simd::sum(v14.column<1>()) << ", last "
+              << v14[4].get<2>() << std::endl;
+
+    // snapshots share nodes with the vector, writes copy only what they touch
+    PersistentVector<int> v15;
+    for (int i = 0; i < 100; ++i)
+        v15.push_back(i);
+    PersistentVector<int> snapshot = v15.snapshot();
+    v15.set(0, -1);
+    v15.push_back(100);
+    std::cout << "Persistent: " << v15.size() << " elements, first " << v15[0] << ", snapshot " << snapshot.size()
+              << " elements, first " << snapshot[0] << std::endl;
+
+    // the elements live in the file, reopening maps them without copying
+    auto path = std::filesystem::temp_directory_path() / "vector_test.bin";
+    std::filesystem::remove(path);
+    {
+        MappedVector<std::int64_t> v16{path};
+        for (std::int64_t i = 0; i < 100000; ++i)
+            v16.push_back(i * i);
+        v16.sync();
+    }
+    MappedVector<std::int64_t> v17{path};
+    std::cout << "Mapped file: " << v17.size() << " elements, last " << v17[v17.size() - 1] << std::endl;
+
+    // a moved-from file vector is empty and can't grow
+    MappedVector<std::int64_t> v17_moved{std::move(v17)};
+    v17.clear();
+    bool grew = true;
+    try {
+        v17.push_back(1);
+    } catch (const std::logic_error&) {
+        grew = false;
+    }
+    std::cout << "Moved mapped file: " << v17_moved.size() << " elements, source " << v17.size() << " elements, "
+              << std::boolalpha << "empty " << v17.empty() << ", grows " << grew << ", " << v17;
+    std::filesystem::remove(path);
+
+    // growth policy and allocation telemetry are compile time choices
+    {
+        Vector<std::string, std::allocator<std::string>, growth::Instrumented<growth::OneAndHalf, GrowthDemo>> v18;
+        for (int i = 0; i < 1000; ++i)
+            v18.push_back(std::to_string(i));
+        std::cout << "OneAndHalf: capacity " << v18.capacity() << " for " << v18.size() << " elements" << std::endl;
+    }
+    growth::TelemetryRegistry::global().write_json(std::cout);
+
+    // growing moves one element per push_back instead of all of them at once
+    IncrementalVector<std::string> v19;
+    for (int i = 0; i < 1500; ++i)
+        v19.push_back(std::to_string(i));
+    std::cout << "Incremental: " << v19.size() << " elements, migrating " << std::boolalpha << v19.migrating()
+              << ", element 100 is " << v19[100] << std::endl;
+
+    // one bit per flag, k bits per small id
+    BitVector<> v20(1000, false);
+    for (std::size_t i = 0; i < v20.size(); i += 7)
+        v20[i] = true;
+    PackedIntVector<12> v21;
+    for (unsigned i = 0; i < 1000; ++i)
+        v21.push_back(static_cast<std::uint16_t>(i * 3 % 4096));
+    std::uint16_t ids[100];
+    v21.unpack(900, 100, ids);
+    std::cout << "Packed: " << v20.count() << " flags set, first clear at " << v20.find_first(false) << ", "
+              << v21.word_count() * 8 << " bytes for " << v21.size() << " ids, id 999 is " << ids[99] << std::endl;
+
+    // a moved-from packed vector is empty and can be refilled
+    BitVector<> v22 = std::move(v20);
+    v20.push_back(true);
+    PackedIntVector<12> v23 = std::move(v21);
+    v21.push_back(7);
+    std::cout << "Moved packed: " << v22.size() << " flags, source refilled to " << v20.size() << ", "
+              << v23.size() << " ids, source refilled to " << v21.size() << std::endl;
+
+    std::uint16_t front[] = {1, 2, 3};
+    v21.insert(v21.cbegin(), std::begin(front), std::end(front));
+    v21.emplace_back(4095);
+    v21.swap(v23);
+    std::cout << "Swapped packed: " << v21.size() << " ids, " << v23.size() << " ids " << v23;
+
     return 0;
 }
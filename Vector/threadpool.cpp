@@ -0,0 +1,151 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/**
+ * pool and queue of the worker running on this thread
+ */
+thread_local ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+} // namespace
+
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    _queues.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        _queues.push_back(std::make_unique<Queue>());
+
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        _workers.emplace_back([this, i] { work(i); });
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{_sleep_mutex};
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+
+void ThreadPool::submit(Task task) {
+    std::size_t index = current_pool == this ? current_index : _next++ % _queues.size();
+    {
+        std::lock_guard lock{_queues[index]->mutex};
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // taking the lock orders the increment with a worker checking before it sleeps
+        std::lock_guard lock{_sleep_mutex};
+        ++_queued;
+    }
+    _wake.notify_one();
+}
+
+
+bool ThreadPool::pop(std::size_t index, Task& task) {
+    Queue& queue = *_queues[index];
+    std::lock_guard lock{queue.mutex};
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    --_queued;
+    return true;
+}
+
+
+bool ThreadPool::steal(std::size_t thief, Task& task) {
+    for (std::size_t offset = 1; offset < _queues.size(); ++offset) {
+        Queue& queue = *_queues[(thief + offset) % _queues.size()];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            --_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+bool ThreadPool::try_run_one() {
+    Task task;
+    std::size_t index = current_pool == this ? current_index : _next % _queues.size();
+    if (!pop(index, task) && !steal(index, task))
+        return false;
+    task();
+    return true;
+}
+
+
+void ThreadPool::work(std::size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    Task task;
+    while (true) {
+        if (pop(index, task) || steal(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock{_sleep_mutex};
+        _wake.wait(lock, [this] { return _stop || _queued > 0; });
+        if (_stop && _queued == 0)
+            return;
+    }
+}
+
+
+TaskGroup::~TaskGroup() {
+    // tasks refer to the group, it can't go away before they are done
+    while (_pending > 0) {
+        if (!_pool.try_run_one())
+            std::this_thread::yield();
+    }
+}
+
+
+void TaskGroup::run(ThreadPool::Task task) {
+    ++_pending;
+    _pool.submit([this, task = std::move(task)] {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard lock{_error_mutex};
+            if (!_error)
+                _error = std::current_exception();
+        }
+        --_pending;
+    });
+}
+
+
+void TaskGroup::wait() {
+    while (_pending > 0) {
+        if (!_pool.try_run_one())
+            std::this_thread::yield();
+    }
+    if (_error)
+        std::rethrow_exception(std::exchange(_error, nullptr));
+}
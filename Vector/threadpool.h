@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * fixed set of worker threads, each with its own task queue.
+ * a worker takes its newest task first and steals the oldest task of another worker when it runs dry,
+ * tasks submitted from a worker go to that worker's queue.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads number of workers, 0 picks the number of hardware threads
+     */
+    explicit ThreadPool(std::size_t threads = 0);
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * finishes the queued tasks, then joins the workers
+     */
+    ~ThreadPool();
+
+    /**
+     * pool shared by the parallel algorithms, sized to the hardware
+     */
+    static ThreadPool& global();
+
+    std::size_t size() const noexcept { return _workers.size(); }
+
+    void submit(Task task);
+
+    /**
+     * run one queued task on the calling thread, so a thread waiting for
+     * its tasks helps instead of blocking
+     * @return false if there was nothing to run
+     */
+    bool try_run_one();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool pop(std::size_t index, Task& task);
+
+    bool steal(std::size_t thief, Task& task);
+
+    void work(std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::atomic<std::size_t> _queued = 0;
+    std::atomic<std::size_t> _next = 0;
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    bool _stop = false;
+};
+
+
+/**
+ * tasks that are waited for together, the waiting thread runs queued tasks meanwhile.
+ * the first exception thrown by a task is rethrown by `wait`.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : _pool{pool} {}
+
+    TaskGroup(const TaskGroup&) = delete;
+
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    ~TaskGroup();
+
+    void run(ThreadPool::Task task);
+
+    void wait();
+
+private:
+    ThreadPool& _pool;
+    std::atomic<std::size_t> _pending = 0;
+    std::mutex _error_mutex;
+    std::exception_ptr _error;
+};
@@ -1,17 +1,45 @@
 #pragma once
 
 #include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth.h"
+#include "storage.h"
+
+
+/**
+ * allocators that can resize a buffer in place or by remapping it,
+ * keeping the contents like realloc does
+ */
+template <typename Allocator>
+concept reallocating_allocator = requires(Allocator& alloc, typename std::allocator_traits<Allocator>::pointer p, std::size_t n) {
+    { alloc.reallocate(p, n, n) } -> std::same_as<typename std::allocator_traits<Allocator>::pointer>;
+};
+
+
+/**
+ * `Growth` picks the new capacity when the Vector runs full, see growth.h.
+ * with `growth::Instrumented` every allocation is also recorded in its Telemetry.
+ */
+template <typename T, typename Allocator = std::allocator<T>, typename Growth = growth::Double>
+class Vector : public detail::ContiguousAccess<Vector<T, Allocator, Growth>, T> {
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using elements = detail::Elements<Allocator>;
 
-template <typename T>
-class Vector {
 public:
     /**
      *  associated types
      */
     using value_type = T;
+    using allocator_type = Allocator;
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
     using reference = value_type&;
@@ -23,174 +51,438 @@ public:
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+    static_assert(std::is_same_v<typename alloc_traits::value_type, value_type>,
+                  "allocator has to allocate value_type");
+    static_assert(std::is_same_v<typename alloc_traits::pointer, pointer>,
+                  "fancy allocator pointers are not supported");
+    static_assert(growth::policy<Growth>, "Growth has to be a growth policy");
+
     Vector() = default;
 
+    explicit Vector(const allocator_type& alloc) noexcept : _alloc(alloc) {}
+
 
-    Vector(size_type n, const_reference default_val) {
-        _size = n;
+    /**
+     * the constructors that build elements delegate to Vector(alloc) first,
+     * so the destructor cleans up if an element constructor throws
+     */
+    Vector(size_type n, const_reference default_val, const allocator_type& alloc = allocator_type())
+        : Vector(alloc) {
+        _data = allocate(n);
         _capacity = n;
-        _data = std::make_unique<value_type[]>(n);
-        std::fill(begin(), end(), default_val);
+        for (; _size < n; ++_size)
+            construct(_data + _size, default_val);
     }
 
 
-    Vector(std::initializer_list<value_type> l) {
-        _size = l.size();
+    Vector(std::initializer_list<value_type> l, const allocator_type& alloc = allocator_type())
+        : Vector(alloc) {
+        _data = allocate(l.size());
         _capacity = l.size();
-        _data = std::make_unique<value_type[]>(l.size());
-        std::copy(l.begin(), l.end(), begin());
+        for (const auto& item : l) {
+            construct(_data + _size, item);
+            ++_size;
+        }
     }
 
-    Vector(const Vector& copy) : _size(copy._size), _capacity(copy._capacity) {
-        _data = std::make_unique<value_type[]>(_capacity);
-        std::copy(copy.cbegin(), copy.cend(), begin());
-    }
+    Vector(const Vector& copy)
+        : Vector(copy, alloc_traits::select_on_container_copy_construction(copy._alloc)) {}
 
-    Vector(Vector&& move)  noexcept : _size(move._size), _capacity(move._capacity) {
-        _data = std::move(move._data);
+    Vector(const Vector& copy, const allocator_type& alloc) : Vector(alloc) {
+        _data = allocate(copy._capacity);
+        _capacity = copy._capacity;
+        for (const auto& item : copy) {
+            construct(_data + _size, item);
+            ++_size;
+        }
     }
 
+    Vector(Vector&& move) noexcept
+        : _size(std::exchange(move._size, 0)),
+          _capacity(std::exchange(move._capacity, 0)),
+          _data(std::exchange(move._data, nullptr)),
+          _alloc(std::move(move._alloc)) {}
+
     /**
      * copy assignment
      */
     Vector& operator=(const Vector& copy) {
-        _capacity = copy._capacity;
-        _size = copy.size();
-        _data = std::make_unique<value_type[]>(copy._capacity);
-        std::copy(copy.cbegin(), copy.cend(), begin());
+        if (this != &copy) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                if (_alloc != copy._alloc)
+                    release();
+                _alloc = copy._alloc;
+            }
+            Vector tmp{copy, _alloc};
+            swap_storage(tmp);
+        }
         return *this;
     }
 
 
     /**
      * move assignment
+     * moves element by element if the allocators differ and don't propagate
      */
-    Vector& operator=(Vector&& move) noexcept {
-        _capacity = move._capacity;
-        _size = move.size();
-        _data = std::move(move._data);
+    Vector& operator=(Vector&& move) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                              alloc_traits::is_always_equal::value) {
+        if (this == &move)
+            return *this;
+
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            release();
+            _alloc = std::move(move._alloc);
+            swap_storage(move);
+        } else {
+            if (_alloc == move._alloc) {
+                release();
+                swap_storage(move);
+            } else {
+                Vector tmp{_alloc};
+                tmp.reserve(move._size);
+                for (auto& item : move)
+                    tmp.emplace_back(std::move(item));
+                swap_storage(tmp);
+                move.clear();
+            }
+        }
         return *this;
     }
 
+    void swap(Vector& other) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(_alloc, other._alloc);
+        }
+        swap_storage(other);
+    }
+
+    allocator_type get_allocator() const noexcept { return _alloc; }
+
     size_type size() const noexcept { return _size; }
 
     size_type capacity() const noexcept { return _capacity; }
 
+    bool empty() const noexcept { return _size == 0; }
+
+    pointer data() noexcept { return _data; }
+
+    const_pointer data() const noexcept { return _data; }
+
+    /**
+     * make room for at least `new_capacity` elements, grows at most once
+     */
+    void reserve(size_type new_capacity) {
+        if (new_capacity > _capacity)
+            reallocate(new_capacity);
+    }
+
+    /**
+     * give back unused capacity
+     */
+    void shrink_to_fit() {
+        if (_capacity > _size)
+            reallocate(_size);
+    }
+
     void push_back(const_reference value) {
-        size_type new_capacity = calculate_capacity(_size + 1);
-        resize(new_capacity);
-        _data[_size++] = value;
+        emplace_back(value);
     }
 
     void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * construct a new last element in place
+     */
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (_size < _capacity) {
+            construct(_data + _size, std::forward<Args>(args)...);
+            return _data[_size++];
+        }
+
+        if constexpr (grows_in_place) {
+            // the arguments may refer to an element, build the value before the buffer moves
+            value_type value(std::forward<Args>(args)...);
+            reallocate(calculate_capacity(_size + 1));
+            construct(_data + _size, std::move(value));
+            return _data[_size++];
+        }
+
+        // the arguments may refer to an element of this vector,
+        // so construct the new element before the old ones are moved away
         size_type new_capacity = calculate_capacity(_size + 1);
-        resize(new_capacity);
-        _data[_size++] = std::move(value);
+        pointer new_data = allocate(new_capacity);
+        try {
+            construct(new_data + _size, std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        try {
+            relocate(_data, _size, new_data);
+        } catch (...) {
+            destroy(new_data + _size, 1);
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        deallocate(_data, _capacity);
+        _data = new_data;
+        _capacity = new_capacity;
+        return _data[_size++];
     }
 
     void pop_back() {
-        _data[--_size] = value_type();
+        alloc_traits::destroy(_alloc, _data + --_size);
     }
 
     /**
-     * with bounds check
+     * destroy all elements, the capacity is kept
      */
-    reference at(const size_type pos) const {
-        if(pos < _size){
-            return _data[pos];
-        }else{
-            throw std::out_of_range{"Invalid position"};
-        }
+    void clear() noexcept {
+        destroy(_data, _size);
+        _size = 0;
     }
 
-    reference at(const size_type pos) {
-        if(pos < _size){
-            return _data[pos];
-        }else{
-            throw std::out_of_range{"Invalid position"};
+    /**
+     * insert [first, last) before `pos`, reallocates at most once
+     * @return iterator to the first inserted element
+     */
+    template <std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        auto offset = static_cast<size_type>(pos - this->cbegin());
+
+        if constexpr (std::forward_iterator<InputIt>) {
+            auto count = static_cast<size_type>(std::distance(first, last));
+            if (count == 0)
+                return this->begin() + offset;
+
+            if constexpr (grows_in_place)
+                reserve(calculate_capacity(_size + count));
+
+            if (_size + count > _capacity) {
+                size_type new_capacity = calculate_capacity(_size + count);
+                pointer new_data = allocate(new_capacity);
+                try {
+                    construct_range(new_data + offset, first, count);
+                } catch (...) {
+                    deallocate(new_data, new_capacity);
+                    throw;
+                }
+                // both parts are in the new buffer before the old elements are discarded,
+                // so a throwing copy leaves this vector as it was
+                size_type moved = 0;
+                try {
+                    transfer(_data, offset, new_data);
+                    moved = offset;
+                    transfer(_data + offset, _size - offset, new_data + offset + count);
+                } catch (...) {
+                    // only copies can throw, the head in the new buffer is a copy of the intact originals
+                    discard(new_data, moved);
+                    destroy(new_data + offset, count);
+                    deallocate(new_data, new_capacity);
+                    throw;
+                }
+                discard(_data, _size);
+                deallocate(_data, _capacity);
+                _data = new_data;
+                _capacity = new_capacity;
+            } else {
+                insert_in_place(offset, first, count);
+            }
+            _size += count;
+        } else {
+            // single pass input: append, then rotate into place
+            size_type old_size = _size;
+            for (; first != last; ++first)
+                emplace_back(*first);
+            std::rotate(this->begin() + offset, this->begin() + old_size, this->end());
         }
+        return this->begin() + offset;
     }
 
     /**
-     * without bounds check
+     * append [first, last), reallocates at most once
      */
-    const_reference operator[](size_type index) const {
-        return _data[index];
+    template <std::input_iterator InputIt>
+    void append(InputIt first, InputIt last) {
+        insert(this->cend(), first, last);
     }
 
-    reference operator[](const size_type index) {
-        return _data[index];
+    ~Vector() {
+        release();
     }
 
+private:
 
-    iterator begin() {
-        return _data.get();
-    }
+    size_type _size = 0;
+    size_type _capacity = 0;
 
-    const_iterator cbegin() const {
-        return _data.get();
-    }
+    /**
+     * raw storage, only the first `_size` slots hold constructed elements
+     */
+    pointer _data = nullptr;
 
-    iterator end() {
-        return _data.get() + _size;
-    }
+    [[no_unique_address]] allocator_type _alloc = allocator_type();
+
+    /**
+     * grow with the allocator's `reallocate`, no element is touched
+     */
+    static constexpr bool grows_in_place = is_trivially_relocatable_v<value_type> && reallocating_allocator<allocator_type>;
 
-    const_iterator cend() const {
-        return _data.get() + _size;
+    static constexpr bool instrumented = growth::instrumented<Growth>;
+
+    pointer allocate(size_type n) {
+        if (n == 0)
+            return nullptr;
+        pointer p = alloc_traits::allocate(_alloc, n);
+        if constexpr (instrumented)
+            Growth::telemetry().record_allocation(n * sizeof(value_type));
+        return p;
     }
 
-    reverse_iterator rbegin() {
-        return reverse_iterator{end()};
+    void deallocate(pointer p, size_type n) {
+        if (p != nullptr) {
+            alloc_traits::deallocate(_alloc, p, n);
+            if constexpr (instrumented)
+                Growth::telemetry().record_deallocation(n * sizeof(value_type));
+        }
     }
 
-    const_reverse_iterator crbegin() const {
-        return const_reverse_iterator{cend()};
+    template <typename... Args>
+    void construct(pointer p, Args&&... args) {
+        elements::construct(_alloc, p, std::forward<Args>(args)...);
     }
 
-    reverse_iterator rend() {
-        return reverse_iterator{begin()};
+    void destroy(pointer first, size_type n) noexcept {
+        elements::destroy(_alloc, first, n);
     }
 
-    const_reverse_iterator crend() {
-        return const_reverse_iterator{cend()};
+    template <typename ForwardIt>
+    void construct_range(pointer dst, ForwardIt first, size_type count) {
+        elements::construct_range(_alloc, dst, first, count);
     }
 
     /**
-     * stream a Vector to an output stream textually
+     * see detail::Elements, all or nothing, the originals still have to be discarded
      */
-    friend std::ostream& operator<<(std::ostream& o, Vector<value_type> v) {
-        o << "Size: " << v._size << ", Capacity: " << v._capacity << std::endl;
-        for (size_type i = 0; i < v._size; ++i) {
-            if (i > 0)
-                o << ", ";
-            o << v._data[i];
-        }
-        o << std::endl;
-        return o;
+    void transfer(pointer src, size_type n, pointer dst) {
+        if constexpr (instrumented)
+            Growth::telemetry().record_growth(n * sizeof(value_type));
+        elements::transfer(_alloc, src, n, dst);
     }
 
-    ~Vector() = default;
+    void discard(pointer src, size_type n) noexcept {
+        elements::discard(_alloc, src, n);
+    }
 
-private:
+    /**
+     * if it throws, nothing was built at `dst` and the originals are intact
+     */
+    void relocate(pointer src, size_type n, pointer dst) {
+        transfer(src, n, dst);
+        discard(src, n);
+    }
 
-    size_type growth_factor = 2;
-    size_type _size;
-    size_type _capacity;
+    void release() noexcept {
+        if constexpr (instrumented) {
+            if (_data != nullptr)
+                Growth::telemetry().record_release((_capacity - _size) * sizeof(value_type));
+        }
+        destroy(_data, _size);
+        deallocate(_data, _capacity);
+        _data = nullptr;
+        _size = 0;
+        _capacity = 0;
+    }
 
-    std::unique_ptr<value_type[]> _data;
+    void swap_storage(Vector& other) noexcept {
+        std::swap(_size, other._size);
+        std::swap(_capacity, other._capacity);
+        std::swap(_data, other._data);
+    }
 
-    size_type calculate_capacity(size_type new_size) {
+    size_type calculate_capacity(size_type new_size) const {
         if(_capacity == 0)
             return new_size;
-        return new_size > _capacity ? _capacity * growth_factor : _capacity;
+        if(new_size <= _capacity)
+            return _capacity;
+        return Growth::next(_capacity, new_size, sizeof(value_type));
+    }
+
+    /**
+     * move all elements into a new buffer of exactly `new_capacity` slots
+     */
+    void reallocate(size_type new_capacity) {
+        if constexpr (grows_in_place) {
+            if (_data != nullptr && new_capacity != 0) {
+                _data = _alloc.reallocate(_data, _capacity, new_capacity);
+                if constexpr (instrumented) {
+                    // whether realloc or mremap copied the bytes isn't visible here
+                    Growth::telemetry().record_deallocation(_capacity * sizeof(value_type));
+                    Growth::telemetry().record_allocation(new_capacity * sizeof(value_type));
+                    Growth::telemetry().record_growth(0);
+                }
+                _capacity = new_capacity;
+                return;
+            }
+        }
+
+        pointer new_data = allocate(new_capacity);
+        try {
+            relocate(_data, _size, new_data);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        deallocate(_data, _capacity);
+        _data = new_data;
+        _capacity = new_capacity;
     }
 
-    void resize(size_type new_capacity) {
-        if(_capacity != new_capacity){
-            std::unique_ptr<value_type[]> new_data = std::make_unique<value_type[]>(new_capacity);
-            std::move(begin(), end(), new_data.get());
-            _data = std::move(new_data);
-            _capacity = new_capacity;
+    /**
+     * shift the tail behind `offset` up by `count` and copy the new elements into the gap,
+     * the capacity has to be sufficient
+     */
+    template <typename ForwardIt>
+    void insert_in_place(size_type offset, ForwardIt first, size_type count) {
+        pointer pos = _data + offset;
+        pointer old_end = _data + _size;
+        auto elems_after = static_cast<size_type>(old_end - pos);
+
+        // elements constructed behind the old end, `_size` doesn't cover them until the caller returns
+        size_type built = 0;
+        try {
+            if (elems_after > count) {
+                for (; built < count; ++built)
+                    construct(old_end + built, std::move(*(old_end - count + built)));
+                std::move_backward(pos, old_end - count, old_end);
+                std::copy_n(first, count, pos);
+            } else {
+                ForwardIt mid = std::next(first, static_cast<difference_type>(elems_after));
+                construct_range(old_end, mid, count - elems_after);
+                built = count - elems_after;
+                for (size_type i = 0; i < elems_after; ++i, ++built)
+                    construct(pos + count + i, std::move(pos[i]));
+                std::copy_n(first, elems_after, pos);
+            }
+        } catch (...) {
+            destroy(old_end, built);
+            throw;
         }
     }
 };
+
+
+namespace pmr {
+
+/**
+ * Vector drawing its memory from a std::pmr::memory_resource, e.g. MonotonicArena or SizeClassPool
+ */
+template <typename T, typename Growth = growth::Double>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, Growth>;
+
+} // namespace pmr
+
@@ -0,0 +1,117 @@
+#include "support.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace bench {
+
+HeapCounters heap;
+
+volatile std::uint64_t sink = 0;
+
+} // namespace bench
+
+
+namespace {
+
+/**
+ * every block starts with its size, so delete can account for it without sized deallocation
+ */
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+void *counted_allocate(std::size_t n) {
+    void *block = std::malloc(n + header_size);
+    if (block == nullptr) {
+        throw std::bad_alloc{};
+    }
+    *static_cast<std::size_t *>(block) = n;
+    auto &heap = bench::heap;
+    ++heap.allocations;
+    heap.live_bytes += n;
+    heap.peak_bytes = std::max(heap.peak_bytes, heap.live_bytes);
+    return static_cast<char *>(block) + header_size;
+}
+
+void counted_deallocate(void *p) noexcept {
+    if (p == nullptr) {
+        return;
+    }
+    void *block = static_cast<char *>(p) - header_size;
+    bench::heap.live_bytes -= *static_cast<std::size_t *>(block);
+    std::free(block);
+}
+
+/**
+ * a whole, non-negative number, std::stoull alone accepts "12x" and wraps "-1"
+ */
+std::uint64_t parse_number(std::string_view flag, const std::string &value) {
+    std::size_t used = 0;
+    std::uint64_t number = 0;
+    try {
+        if (not value.empty() and value.front() != '-') {
+            number = std::stoull(value, &used);
+        }
+    } catch (const std::logic_error &) {
+        used = 0;
+    }
+    if (used == 0 or used != value.size()) {
+        throw std::invalid_argument{"invalid value for " + std::string{flag} + ": " + value};
+    }
+    return number;
+}
+
+} // namespace
+
+
+void *operator new(std::size_t n) { return counted_allocate(n); }
+
+void *operator new[](std::size_t n) { return counted_allocate(n); }
+
+void operator delete(void *p) noexcept { counted_deallocate(p); }
+
+void operator delete[](void *p) noexcept { counted_deallocate(p); }
+
+void operator delete(void *p, std::size_t) noexcept { counted_deallocate(p); }
+
+void operator delete[](void *p, std::size_t) noexcept { counted_deallocate(p); }
+
+
+namespace bench {
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i += 2) {
+        std::string_view flag{argv[i]};
+        // asked for only once the flag is known, so an unknown last flag isn't reported as missing a value
+        auto value = [&]() -> std::string {
+            if (i + 1 == argc) {
+                throw std::invalid_argument{"missing value for " + std::string{flag}};
+            }
+            return argv[i + 1];
+        };
+        if (flag == "--min-size") {
+            options.min_size = parse_number(flag, value());
+        } else if (flag == "--max-size") {
+            options.max_size = parse_number(flag, value());
+        } else if (flag == "--work") {
+            options.work = parse_number(flag, value());
+        } else if (flag == "--seed") {
+            options.seed = parse_number(flag, value());
+        } else {
+            throw std::invalid_argument{"unknown option: " + std::string{flag}};
+        }
+    }
+    if (options.min_size == 0) {
+        throw std::invalid_argument{"--min-size must be at least 1"};
+    }
+    if (options.max_size < options.min_size) {
+        throw std::invalid_argument{"--max-size must not be below --min-size"};
+    }
+    return options;
+}
+
+} // namespace bench
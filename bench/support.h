@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/**
+ * scaffolding shared by the size sweep benchmarks (vector_bench, map_bench).
+ *
+ * linking it replaces the global operator new and delete with ones that count the heap
+ * usage of the whole program. build with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.
+ */
+namespace bench {
+
+struct HeapCounters {
+    std::size_t allocations = 0;
+    std::size_t live_bytes = 0;
+    std::size_t peak_bytes = 0;
+};
+
+/**
+ * updated by every operator new and delete, not thread safe
+ */
+extern HeapCounters heap;
+
+/**
+ * keeps results alive so the measured loops aren't optimized away
+ */
+extern volatile std::uint64_t sink;
+
+
+/**
+ * sizes min_size, 10 * min_size, ... up to max_size, each repeated about work / size times
+ */
+struct Options {
+    std::size_t min_size = 10;
+    std::size_t max_size = 1000000;
+    std::size_t work = 10000000;
+    std::uint64_t seed = 42;
+};
+
+/**
+ * reads --min-size N --max-size N --work N --seed N, every flag needs a value
+ * throws std::invalid_argument
+ */
+Options parse_options(int argc, char **argv);
+
+} // namespace bench
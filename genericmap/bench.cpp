@@ -0,0 +1,224 @@
+#include "frozenmap.h"
+#include "support.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * compares FrozenMap with std::unordered_map and std::map for uint64 and std::string keys
+ * at sizes 10, 100, ... up to --max-size.
+ *
+ * every case reports the time to build the map per entry, the time per lookup of present keys
+ * in random order and of absent keys, and the heap the built map holds per entry.
+ * results are printed as JSON, one case per line.
+ *
+ * options: --min-size N --max-size N --work N --seed N, see bench::parse_options
+ */
+
+namespace {
+
+using bench::sink;
+
+
+/**
+ * key types and how to make one from a random number
+ */
+struct Uint64 {
+    using type = std::uint64_t;
+    static constexpr const char *name = "uint64";
+
+    static type make(std::uint64_t random) {
+        return random;
+    }
+};
+
+struct String {
+    using type = std::string;
+    static constexpr const char *name = "string";
+
+    /**
+     * identifiers of 12 to 27 characters, past the small string buffer
+     */
+    static type make(std::uint64_t random) {
+        return "identifier_" + std::to_string(random % 10000000000000000ull);
+    }
+};
+
+
+/**
+ * the containers, built from the same entries and looked up the same way
+ */
+template<typename K>
+struct Frozen {
+    using type = FrozenMap<K, std::uint64_t>;
+    static constexpr const char *name = "FrozenMap";
+
+    static type build(const std::vector<std::pair<K, std::uint64_t>> &entries) {
+        return type(entries.begin(), entries.end());
+    }
+
+    static std::uint64_t get(const type &map, const K &key) {
+        return map.get(key);
+    }
+};
+
+template<typename K>
+struct Unordered {
+    using type = std::unordered_map<K, std::uint64_t>;
+    static constexpr const char *name = "std::unordered_map";
+
+    static type build(const std::vector<std::pair<K, std::uint64_t>> &entries) {
+        return type(entries.begin(), entries.end());
+    }
+
+    static std::uint64_t get(const type &map, const K &key) {
+        return map.at(key);
+    }
+};
+
+template<typename K>
+struct Ordered {
+    using type = std::map<K, std::uint64_t>;
+    static constexpr const char *name = "std::map";
+
+    static type build(const std::vector<std::pair<K, std::uint64_t>> &entries) {
+        return type(entries.begin(), entries.end());
+    }
+
+    static std::uint64_t get(const type &map, const K &key) {
+        return map.at(key);
+    }
+};
+
+
+template<typename Body>
+double ns_per_item(std::size_t reps, std::size_t items, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t rep = 0; rep < reps; ++rep) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(reps * std::max<std::size_t>(items, 1));
+}
+
+
+/**
+ * all measurements for one container, key type and size
+ */
+template<typename Container, typename Keys>
+void run_container(std::size_t n, const std::vector<std::pair<typename Keys::type, std::uint64_t>> &entries,
+                   const std::vector<typename Keys::type> &hits, const std::vector<typename Keys::type> &misses,
+                   const bench::Options &options, bool &first) {
+    const std::size_t reps = std::max<std::size_t>(1, options.work / n);
+
+    double build = ns_per_item(std::max<std::size_t>(1, reps / 10), n, [&] {
+        auto map = Container::build(entries);
+        sink = sink + map.size();
+    });
+
+    std::size_t baseline = bench::heap.live_bytes;
+    auto map = Container::build(entries);
+    std::size_t heap_bytes = bench::heap.live_bytes - baseline;
+
+    double hit = ns_per_item(reps, hits.size(), [&] {
+        std::uint64_t sum = 0;
+        for (const auto &key : hits) {
+            sum += Container::get(map, key);
+        }
+        sink = sink + sum;
+    });
+
+    double miss = ns_per_item(reps, misses.size(), [&] {
+        std::uint64_t found = 0;
+        for (const auto &key : misses) {
+            found += map.contains(key);
+        }
+        sink = sink + found;
+    });
+
+    std::cout << (first ? "" : ",\n") << "    {\"type\": \"" << Keys::name << "\", \"size\": " << n
+              << ", \"container\": \"" << Container::name << "\""
+              << ", \"build_ns_per_entry\": " << build
+              << ", \"hit_ns\": " << hit
+              << ", \"miss_ns\": " << miss
+              << ", \"heap_bytes_per_entry\": " << static_cast<double>(heap_bytes) / static_cast<double>(n) << "}";
+    first = false;
+}
+
+
+template<typename Keys>
+void run_type(const bench::Options &options, bool &first) {
+    using K = typename Keys::type;
+    for (std::size_t n = options.min_size; n <= options.max_size; n *= 10) {
+        std::mt19937_64 random{options.seed};
+        std::unordered_set<K> seen;
+        std::vector<std::pair<K, std::uint64_t>> entries;
+        entries.reserve(n);
+        while (entries.size() < n) {
+            K key = Keys::make(random());
+            if (seen.insert(key).second) {
+                entries.emplace_back(std::move(key), entries.size());
+            }
+        }
+
+        std::vector<K> hits;
+        std::vector<K> misses;
+        std::uniform_int_distribution<std::size_t> pick{0, n - 1};
+        for (std::size_t i = 0; i < n; ++i) {
+            hits.push_back(entries[pick(random)].first);
+            K key = Keys::make(random());
+            while (seen.count(key) != 0) {
+                key = Keys::make(random());
+            }
+            misses.push_back(std::move(key));
+        }
+
+        run_container<Frozen<K>, Keys>(n, entries, hits, misses, options, first);
+        run_container<Unordered<K>, Keys>(n, entries, hits, misses, options, first);
+        run_container<Ordered<K>, Keys>(n, entries, hits, misses, options, first);
+
+        if (n > options.max_size / 10) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+
+int main(int argc, char **argv) {
+    bench::Options options;
+    try {
+        options = bench::parse_options(argc, argv);
+    } catch (std::exception &err) {
+        std::cerr << err.what() << std::endl;
+        return 2;
+    }
+
+    std::cout << "{\n"
+              << "  \"min_size\": " << options.min_size << ",\n"
+              << "  \"max_size\": " << options.max_size << ",\n"
+              << "  \"work\": " << options.work << ",\n"
+              << "  \"seed\": " << options.seed << ",\n"
+              << "  \"results\": [\n";
+
+    bool first = true;
+    run_type<Uint64>(options, first);
+    run_type<String>(options, first);
+
+    std::cout << "\n  ]\n"
+              << "}" << std::endl;
+    return 0;
+}
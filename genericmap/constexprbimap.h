@@ -0,0 +1,94 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "constexprmap.h"
+
+
+/**
+ * compiletime bidirectional lookup map, for name <-> id tables
+ *
+ * both directions are built from one entry list and are a CexprMap each, so lookups in
+ * either direction use the fastest layout for their key type (perfect hash, direct index,
+ * SIMD probe or binary search). keys and values both have to be unique,
+ * a repeated key or value throws std::invalid_argument (a compile error in constant evaluation).
+ */
+template<typename K, typename V, size_t count>
+class CexprBimap {
+public:
+    using key_type = K;
+    using value_type = V;
+
+    template<class... Entries>
+    constexpr CexprBimap(const Entries&... entries)
+        : by_key(std::pair<K, V>(entries.first, entries.second)...),
+          by_value(std::pair<V, K>(entries.second, entries.first)...) {}
+
+
+    constexpr size_t size() const {
+        return count;
+    }
+
+    constexpr bool contains(const K &key) const {
+        return by_key.contains(key);
+    }
+
+    constexpr bool contains_value(const V &value) const {
+        return by_value.contains(value);
+    }
+
+
+    /**
+     * value of `key`, throws std::out_of_range
+     */
+    constexpr const V &get(const K &key) const {
+        return by_key.get(key);
+    }
+
+    /**
+     * key of `value`, throws std::out_of_range
+     */
+    constexpr const K &get_key(const V &value) const {
+        return by_value.get(value);
+    }
+
+
+    constexpr const V &operator [](const K &key) const {
+        return get(key);
+    }
+
+    /**
+     * the key -> value direction
+     */
+    constexpr const CexprMap<K, V, count> &forward() const {
+        return by_key;
+    }
+
+    /**
+     * the value -> key direction
+     */
+    constexpr const CexprMap<V, K, count> &backward() const {
+        return by_value;
+    }
+
+private:
+    CexprMap<K, V, count> by_key;
+    CexprMap<V, K, count> by_value;
+};
+
+
+/**
+ * helper function, returns CexprBimap
+ */
+template<typename K, typename V, typename... Entries>
+constexpr auto create_cexpr_bimap(Entries&&... entry) {
+    return CexprBimap<K, V, sizeof...(entry)>(std::forward<Entries>(entry)...);
+}
+
+/**
+ * template deduction guide
+ */
+template<typename Entry, typename... Rest>
+requires std::conjunction_v<std::is_same<Entry, Rest>...>
+CexprBimap(Entry, Rest&&...) -> CexprBimap<typename Entry::first_type, typename Entry::second_type, sizeof...(Rest) + 1>;
@@ -1,14 +1,171 @@
 #pragma once
 
 #include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <stdexcept>
 #include <algorithm>
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+/**
+ * constexpr hash of a key, specialize it to give CexprMap a perfect hash table for a key type
+ */
+template<typename K>
+struct CexprHash;
+
+/**
+ * FNV-1a, finished with the murmur3 mixer so all bits depend on every character
+ */
+template<>
+struct CexprHash<std::string_view> {
+    constexpr std::uint64_t operator ()(std::string_view key) const {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return mix(hash);
+    }
+
+    static constexpr std::uint64_t mix(std::uint64_t hash) {
+        hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+        hash = (hash ^ (hash >> 33)) * 0xc4ceb9fe1a85ec53ull;
+        return hash ^ (hash >> 33);
+    }
+};
+
+template<typename K>
+concept cexpr_hashable = requires(const K &key) {
+    { CexprHash<K>{}(key) } -> std::same_as<std::uint64_t>;
+};
+
+
+namespace detail {
+
+/**
+ * bytes compared per instruction by probe_keys
+ */
+#if defined(__AVX2__)
+inline constexpr size_t probe_width = 32;
+#else
+inline constexpr size_t probe_width = 16;
+#endif
+
+/**
+ * index of the first of `n` keys equal to `key`, `n` if there is none.
+ * `keys` is aligned to and padded to a multiple of probe_width bytes, the padding
+ * must not hold `key` unless an earlier key does.
+ */
+template<typename T>
+inline size_t probe_keys(const T *keys, size_t n, T key) {
+#if defined(__SSE2__)
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+    constexpr size_t lanes = probe_width / sizeof(T);
+#if defined(__AVX2__)
+    using block = __m256i;
+#else
+    using block = __m128i;
+#endif
+    block needle;
+    if constexpr (sizeof(T) == 1) {
+#if defined(__AVX2__)
+        needle = _mm256_set1_epi8(static_cast<char>(key));
+#else
+        needle = _mm_set1_epi8(static_cast<char>(key));
+#endif
+    } else if constexpr (sizeof(T) == 2) {
+#if defined(__AVX2__)
+        needle = _mm256_set1_epi16(static_cast<short>(key));
+#else
+        needle = _mm_set1_epi16(static_cast<short>(key));
+#endif
+    } else if constexpr (sizeof(T) == 4) {
+#if defined(__AVX2__)
+        needle = _mm256_set1_epi32(static_cast<int>(key));
+#else
+        needle = _mm_set1_epi32(static_cast<int>(key));
+#endif
+    } else {
+#if defined(__AVX2__)
+        needle = _mm256_set1_epi64x(static_cast<long long>(key));
+#else
+        needle = _mm_set1_epi64x(static_cast<long long>(key));
+#endif
+    }
+
+    for (size_t i = 0; i < n; i += lanes) {
+#if defined(__AVX2__)
+        block keys_block = _mm256_load_si256(reinterpret_cast<const block *>(keys + i));
+        block equal;
+        if constexpr (sizeof(T) == 1) {
+            equal = _mm256_cmpeq_epi8(keys_block, needle);
+        } else if constexpr (sizeof(T) == 2) {
+            equal = _mm256_cmpeq_epi16(keys_block, needle);
+        } else if constexpr (sizeof(T) == 4) {
+            equal = _mm256_cmpeq_epi32(keys_block, needle);
+        } else {
+            equal = _mm256_cmpeq_epi64(keys_block, needle);
+        }
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(equal));
+#else
+        block keys_block = _mm_load_si128(reinterpret_cast<const block *>(keys + i));
+        block equal;
+        if constexpr (sizeof(T) == 1) {
+            equal = _mm_cmpeq_epi8(keys_block, needle);
+        } else if constexpr (sizeof(T) == 2) {
+            equal = _mm_cmpeq_epi16(keys_block, needle);
+        } else if constexpr (sizeof(T) == 4) {
+            equal = _mm_cmpeq_epi32(keys_block, needle);
+        } else {
+            // SSE2 has no 64 bit compare: both 32 bit halves have to match
+            equal = _mm_cmpeq_epi32(keys_block, needle);
+            equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(equal));
+#endif
+        if (mask != 0) {
+            size_t found = i + static_cast<size_t>(std::countr_zero(mask)) / sizeof(T);
+            return found < n ? found : n;
+        }
+    }
+    return n;
+#else
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i] == key) {
+            return i;
+        }
+    }
+    return n;
+#endif
+}
+
+} // namespace detail
+
 
 /**
  * compiletime generic lookup map
+ *
+ * keys with a CexprHash (std::string_view) get a minimal perfect hash table built at compile time
+ * with CHD (hash, displace and compress): keys are grouped into buckets by their hash and every
+ * bucket, largest first, searches for a displacement that moves its keys to free slots.
+ * a lookup is one hash of the key, one displacement load and one key compare.
+ *
+ * other keys with a total order (except pointers) are sorted when the map is constructed,
+ * duplicates are found among neighbours and lookups are a branchless binary search, so tables with thousands
+ * of entries stay within the constexpr step limits and are fast at runtime too.
+ * integral and enum keys that fall into a range of at most 4 * count values (opcodes, enums,
+ * status codes) are looked up directly instead: a bitmap over the range marks the present keys
+ * and the number of set bits before a key is its index among the sorted entries.
+ * small maps of sparse integral keys also keep the keys in an aligned array of their own that
+ * runtime lookups compare 16 or 32 bytes at a time, the values are only read on a hit.
+ * the remaining keys only need == and are searched linearly.
  */
 template<typename K, typename V, size_t count>
 class CexprMap {
@@ -16,9 +173,50 @@ public:
     using key_type = K;
     using value_type = V;
 
+    /**
+     * whether the entries are placed by a perfect hash
+     */
+    static constexpr bool hashed = cexpr_hashable<K> && std::is_move_assignable_v<K> && std::is_move_assignable_v<V>;
+
+    /**
+     * whether the entries are kept sorted by key. pointers stay unsorted, comparing pointers
+     * into unrelated objects (e.g. string literals) with < is not a constant expression
+     */
+    static constexpr bool sorted = !hashed && std::totally_ordered<K> && !std::is_pointer_v<K> &&
+                                   std::is_move_assignable_v<K> && std::is_move_assignable_v<V>;
+
+    /**
+     * whether dense keys can be direct indexed, decided per map by is_dense()
+     */
+    static constexpr bool indexable = sorted && ((std::integral<K> && !std::same_as<K, bool>) || std::is_enum_v<K>);
+
+    /**
+     * whether runtime lookups of sparse keys scan a separate key array with SIMD compares
+     */
+    static constexpr bool probed = indexable && count > 0 && count <= 64;
+
+    /**
+     * a failed perfect hash construction is a compile error in constant evaluation
+     * and throws std::logic_error at runtime
+     */
     template<class... Entries>
     constexpr CexprMap(Entries&&... entries) : values{std::forward<Entries>(entries)...}{
+        if constexpr (hashed) {
+            build_perfect_hash();
+            return;
+        }
+        if constexpr (sorted) {
+            std::sort(values.begin(), values.end(), [](auto &a, auto &b){
+                return a.first < b.first;
+            });
+        }
         verify_no_duplicates();
+        if constexpr (indexable) {
+            build_index();
+        }
+        if constexpr (probed) {
+            build_keys();
+        }
     }
 
 
@@ -44,12 +242,34 @@ public:
         return get(key);
     }
 
+    /**
+     * whether lookups index the entries directly, the keys span at most 4 * count values.
+     * density is only known once the keys are, so every indexable map carries the index,
+     * 6 bits per entry (3 KB for 4000 entries), also when it turns out sparse and never reads it
+     */
+    constexpr bool is_dense() const {
+        return dense;
+    }
+
 private:
     /**
-     * checks if keys are duplicated
+     * checks if keys are duplicated, sorted keys only need to be compared to their neighbour
      * throws std::invalid_argument
      */
     constexpr void verify_no_duplicates() const {
+        if constexpr (hashed) {
+            // equal keys collide on every displacement, build_perfect_hash reports them
+            return;
+        }
+        if constexpr (sorted) {
+            auto duplicate = std::adjacent_find(values.begin(), values.end(), [](auto &a, auto &b){
+                return a.first == b.first;
+            });
+            if (duplicate != values.end()) {
+                throw std::invalid_argument{"keys duplicated"};
+            }
+            return;
+        }
         for (auto first = values.begin(); first != values.end(); ++first) {
             auto current = *first;
             auto duplicate = std::find_if(first + 1, values.end(), [&current](auto &entry){
@@ -62,12 +282,241 @@ private:
     }
 
     constexpr auto find(const K &key) const {
-       return std::find_if(values.begin(), values.end(), [&key](auto &entry){
-           return entry.first == key;
-       });
+        if constexpr (hashed) {
+            if (count == 0) {
+                return values.end();
+            }
+            std::uint64_t hash = CexprHash<K>{}(key);
+            auto entry = values.begin() + slot(hash, displacements[bucket(hash)]);
+            return entry->first == key ? entry : values.end();
+        } else if constexpr (sorted) {
+            if constexpr (indexable) {
+                if (dense) {
+                    return find_indexed(key);
+                }
+            }
+            if constexpr (probed) {
+                // intrinsics can't run in constant evaluation
+                if (!std::is_constant_evaluated()) {
+                    return values.begin() + detail::probe_keys(keys.data(), count, static_cast<key_bits>(key));
+                }
+            }
+            return lower_bound(key);
+        } else {
+            return std::find_if(values.begin(), values.end(), [&key](auto &entry){
+                return entry.first == key;
+            });
+        }
+    }
+
+    /**
+     * the entry with `key` or end, halves the range without branching on the comparison
+     * so the loop runs log2(count) times whatever the key is
+     */
+    constexpr auto lower_bound(const K &key) const {
+        if (count == 0) {
+            return values.end();
+        }
+        auto base = values.begin();
+        for (size_t n = count; n > 1; n -= n / 2) {
+            base = base[n / 2 - 1].first < key ? base + n / 2 : base;
+        }
+        if (base->first < key) {
+            ++base;
+        }
+        return base != values.end() && base->first == key ? base : values.end();
+    }
+
+    /**
+     * the integer behind an integral or enum key
+     */
+    using key_bits = typename std::conditional_t<std::is_enum_v<K>, std::underlying_type<K>, std::type_identity<K>>::type;
+
+    /**
+     * distance of `key` from the smallest key, wraps around to a huge value below it
+     */
+    static constexpr std::uint64_t offset(const K &key, std::uint64_t base) {
+        using wide = std::conditional_t<std::is_signed_v<key_bits>, std::int64_t, std::uint64_t>;
+        return static_cast<std::uint64_t>(static_cast<wide>(static_cast<key_bits>(key))) - base;
+    }
+
+    /**
+     * copy the sorted keys into their own array, the padding repeats the first key so it
+     * can only match where the first key already did
+     */
+    constexpr void build_keys() {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i] = static_cast<key_bits>(values[i < count ? i : 0].first);
+        }
+    }
+
+    /**
+     * bitmap of the present keys plus the number of keys before each word, if the keys are dense enough
+     */
+    constexpr void build_index() {
+        if (count == 0) {
+            return;
+        }
+        std::uint64_t base = offset(values.front().first, 0);
+        if (offset(values.back().first, base) >= index_words * 64) {
+            return;
+        }
+        for (const auto &entry : values) {
+            std::uint64_t bit = offset(entry.first, base);
+            present[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+        std::uint32_t before = 0;
+        for (size_t w = 0; w < index_words; ++w) {
+            ranks[w] = before;
+            before += static_cast<std::uint32_t>(std::popcount(present[w]));
+        }
+        index_base = base;
+        dense = true;
+    }
+
+    constexpr auto find_indexed(const K &key) const {
+        std::uint64_t bit = offset(key, index_base);
+        if (bit >= index_words * 64) {
+            return values.end();
+        }
+        std::uint64_t word = present[bit / 64];
+        std::uint64_t mask = std::uint64_t{1} << (bit % 64);
+        if ((word & mask) == 0) {
+            return values.end();
+        }
+        return values.begin() + (ranks[bit / 64] + static_cast<size_t>(std::popcount(word & (mask - 1))));
+    }
+
+    /**
+     * maps 32 bits of a hash onto [0, count) without a division
+     */
+    static constexpr size_t reduce(std::uint64_t bits) {
+        return static_cast<size_t>(((bits & 0xffffffffull) * count) >> 32);
+    }
+
+    static constexpr size_t bucket(std::uint64_t hash) {
+        return reduce(hash >> 32);
+    }
+
+    static constexpr size_t slot(std::uint64_t hash, std::uint32_t displacement) {
+        return reduce(CexprHash<std::string_view>::mix(hash + displacement * 0x9e3779b97f4a7c15ull));
+    }
+
+    /**
+     * most displacements tried per bucket before giving up
+     */
+    static constexpr std::uint32_t max_displacement = 1u << 16;
+
+    /**
+     * CHD with one bucket per key on average and a table without empty slots,
+     * then moves every entry to its slot
+     */
+    constexpr void build_perfect_hash() {
+        if (count == 0) {
+            return;
+        }
+        std::array<std::uint64_t, count> hashes{};
+        std::array<size_t, count> bucket_size{};
+        std::array<size_t, count> order{};
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = CexprHash<K>{}(values[i].first);
+            ++bucket_size[bucket(hashes[i])];
+            order[i] = i;
+        }
+
+        // keys of a bucket next to each other, largest buckets first while many slots are free
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            size_t bucket_a = bucket(hashes[a]);
+            size_t bucket_b = bucket(hashes[b]);
+            if (bucket_size[bucket_a] != bucket_size[bucket_b]) {
+                return bucket_size[bucket_a] > bucket_size[bucket_b];
+            }
+            return bucket_a < bucket_b;
+        });
+
+        std::array<bool, count> taken{};
+        std::array<size_t, count> target{};
+        for (size_t first = 0; first < count;) {
+            size_t b = bucket(hashes[order[first]]);
+            size_t last = first + bucket_size[b];
+            for (size_t i = first; i < last; ++i) {
+                for (size_t j = first; j < i; ++j) {
+                    if (hashes[order[i]] == hashes[order[j]]) {
+                        if (values[order[i]].first == values[order[j]].first) {
+                            throw std::invalid_argument{"keys duplicated"};
+                        }
+                        throw std::logic_error{"perfect hash construction failed: keys with equal hashes"};
+                    }
+                }
+            }
+            displacements[b] = find_displacement(hashes, order, first, last, taken);
+            for (size_t i = first; i < last; ++i) {
+                size_t s = slot(hashes[order[i]], displacements[b]);
+                taken[s] = true;
+                target[order[i]] = s;
+            }
+            first = last;
+        }
+
+        // apply the permutation in place, entries need not be default constructible
+        for (size_t i = 0; i < count; ++i) {
+            while (target[i] != i) {
+                size_t j = target[i];
+                std::swap(values[i], values[j]);
+                std::swap(target[i], target[j]);
+            }
+        }
+    }
+
+    /**
+     * the first displacement moving all keys in order[first, last) to distinct free slots
+     */
+    static constexpr std::uint32_t find_displacement(const std::array<std::uint64_t, count> &hashes,
+                                                     const std::array<size_t, count> &order,
+                                                     size_t first, size_t last,
+                                                     const std::array<bool, count> &taken) {
+        for (std::uint32_t displacement = 0; displacement < max_displacement; ++displacement) {
+            bool fits = true;
+            for (size_t i = first; i < last && fits; ++i) {
+                size_t s = slot(hashes[order[i]], displacement);
+                fits = !taken[s];
+                for (size_t j = first; j < i && fits; ++j) {
+                    fits = slot(hashes[order[j]], displacement) != s;
+                }
+            }
+            if (fits) {
+                return displacement;
+            }
+        }
+        throw std::logic_error{"perfect hash construction failed: no displacement found"};
     }
 
     std::array<std::pair<K, V>, count> values;
+
+    /**
+     * per bucket, only used by the perfect hash layout
+     */
+    std::array<std::uint32_t, hashed ? count : 0> displacements{};
+
+    /**
+     * direct index of dense integral keys, 1.5 bits per possible key. array sizes have to
+     * come from the type, so it is sized for the densest case whether is_dense() or not
+     */
+    static constexpr size_t index_words = indexable ? (4 * count + 63) / 64 : 0;
+
+    std::array<std::uint64_t, index_words> present{};
+    std::array<std::uint32_t, index_words> ranks{};
+    std::uint64_t index_base = 0;
+    bool dense = false;
+
+    /**
+     * keys of small sparse maps for probe_keys, padded to whole SIMD blocks
+     */
+    static constexpr size_t probe_lanes = detail::probe_width / sizeof(key_bits);
+
+    using key_array = std::array<key_bits, probed ? (count + probe_lanes - 1) / probe_lanes * probe_lanes : 0>;
+
+    alignas(probed ? detail::probe_width : alignof(key_array)) key_array keys{};
 };
 
 
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <stdexcept>
+#include <utility>
+
+
+/**
+ * a half open key range [low, high) and its value
+ */
+template<typename K, typename V>
+struct CexprRange {
+    K low;
+    K high;
+    V value;
+};
+
+
+/**
+ * compiletime lookup map from non-overlapping key ranges to values,
+ * for size buckets, character classes or price tiers that would otherwise be an if chain
+ *
+ * the ranges are sorted by their lower bound when the map is constructed, an empty range or
+ * two overlapping ranges throw std::invalid_argument (a compile error in constant evaluation).
+ * gaps between the ranges are allowed, keys in them are not contained.
+ * a lookup is a branchless search for the last range starting at or before the key
+ * and one compare with its upper bound.
+ */
+template<std::totally_ordered K, typename V, size_t count>
+class CexprRangeMap {
+public:
+    using key_type = K;
+    using value_type = V;
+
+    template<class... Entries>
+    constexpr CexprRangeMap(Entries&&... entries) : ranges{std::forward<Entries>(entries)...}{
+        std::sort(ranges.begin(), ranges.end(), [](auto &a, auto &b){
+            return a.low < b.low;
+        });
+        verify_ranges();
+    }
+
+
+    constexpr size_t size() const {
+        return count;
+    }
+
+    constexpr bool contains(const K &key) const {
+        return find(key) != ranges.end();
+    }
+
+
+    constexpr const V &get(const K &key) const {
+        auto result = find(key);
+        if (result == ranges.end()) {
+            throw std::out_of_range{"get value failed"};
+        }
+        return result->value;
+    }
+
+
+    constexpr const V &operator [](const K &key) const {
+        return get(key);
+    }
+
+private:
+    /**
+     * sorted ranges only need to be compared to their neighbour
+     * throws std::invalid_argument
+     */
+    constexpr void verify_ranges() const {
+        for (const auto &range : ranges) {
+            if (!(range.low < range.high)) {
+                throw std::invalid_argument{"range empty"};
+            }
+        }
+        auto overlap = std::adjacent_find(ranges.begin(), ranges.end(), [](auto &a, auto &b){
+            return b.low < a.high;
+        });
+        if (overlap != ranges.end()) {
+            throw std::invalid_argument{"ranges overlap"};
+        }
+    }
+
+    /**
+     * the range holding `key` or end, halves the ranges without branching on the comparison
+     * so the loop runs log2(count) times whatever the key is
+     */
+    constexpr auto find(const K &key) const {
+        if (count == 0) {
+            return ranges.end();
+        }
+        auto base = ranges.begin();
+        for (size_t n = count; n > 1; n -= n / 2) {
+            base = key < base[n / 2].low ? base : base + n / 2;
+        }
+        return !(key < base->low) && key < base->high ? base : ranges.end();
+    }
+
+    std::array<CexprRange<K, V>, count> ranges;
+};
+
+
+/**
+ * helper function, returns CexprRangeMap
+ */
+template<typename K, typename V, size_t count>
+constexpr auto create_cexpr_range_map(const CexprRange<K, V> (&ranges)[count]) {
+    return [&]<size_t... i>(std::index_sequence<i...>) {
+        return CexprRangeMap<K, V, count>(ranges[i]...);
+    }(std::make_index_sequence<count>{});
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "constexprmap.h"
+
+
+/**
+ * runtime generic lookup map, built once and read-only afterwards
+ *
+ * for tables that are only known at startup but never change after. the entries are placed
+ * by a minimal perfect hash built with CHD like CexprMap's string tables: keys are grouped into
+ * buckets by their hash, buckets with several keys search for a displacement moving their keys
+ * to free slots, largest first, and single key buckets then take the remaining slots directly.
+ * the table has no empty slots and 4 bytes per key on top of the entries.
+ * a lookup is one hash, one displacement load and one key compare.
+ *
+ * there is no way to modify a built map, so it can be shared between threads without locks.
+ */
+template<typename K, typename V, typename Hash = std::hash<K>>
+class FrozenMap {
+public:
+    using key_type = K;
+    using value_type = V;
+    using const_iterator = typename std::vector<std::pair<K, V>>::const_iterator;
+
+    /**
+     * a repeated key throws std::invalid_argument, keys with equal hashes that the
+     * perfect hash can't separate throw std::logic_error
+     */
+    explicit FrozenMap(std::vector<std::pair<K, V>> entries, Hash hasher = Hash{}) : hasher{std::move(hasher)}{
+        build_perfect_hash(entries);
+    }
+
+    template<std::input_iterator It>
+    FrozenMap(It first, It last, Hash hasher = Hash{})
+        : FrozenMap(std::vector<std::pair<K, V>>(first, last), std::move(hasher)) {}
+
+    FrozenMap(std::initializer_list<std::pair<K, V>> entries, Hash hasher = Hash{})
+        : FrozenMap(std::vector<std::pair<K, V>>(entries), std::move(hasher)) {}
+
+
+    size_t size() const {
+        return values.size();
+    }
+
+    bool contains(const K &key) const {
+        return find(key) != values.end();
+    }
+
+
+    const V &get(const K &key) const {
+        auto result = find(key);
+        if (result == values.end()) {
+            throw std::out_of_range{"get value failed"};
+        }
+        return result->second;
+    }
+
+
+    const V &operator [](const K &key) const {
+        return get(key);
+    }
+
+    /**
+     * the entries in slot order, which is unrelated to the key order
+     */
+    const_iterator begin() const {
+        return values.begin();
+    }
+
+    const_iterator end() const {
+        return values.end();
+    }
+
+private:
+    const_iterator find(const K &key) const {
+        if (values.empty()) {
+            return values.end();
+        }
+        std::uint64_t hash = hash_key(key);
+        auto entry = values.begin() + static_cast<std::ptrdiff_t>(place(hash, displacements[bucket(hash)]));
+        return entry->first == key ? entry : values.end();
+    }
+
+    /**
+     * std::hash of integers is the identity, the mixer spreads it over all bits
+     */
+    std::uint64_t hash_key(const K &key) const {
+        return CexprHash<std::string_view>::mix(static_cast<std::uint64_t>(hasher(key)));
+    }
+
+    /**
+     * maps 32 bits of a hash onto [0, table_size) without a division
+     */
+    size_t reduce(std::uint64_t bits) const {
+        return static_cast<size_t>(((bits & 0xffffffffull) * table_size) >> 32);
+    }
+
+    size_t bucket(std::uint64_t hash) const {
+        return reduce(hash >> 32);
+    }
+
+    size_t slot(std::uint64_t hash, std::uint32_t displacement) const {
+        return reduce(CexprHash<std::string_view>::mix(hash + displacement * 0x9e3779b97f4a7c15ull));
+    }
+
+    /**
+     * the slot of a key, single key buckets store it directly
+     */
+    size_t place(std::uint64_t hash, std::uint32_t displacement) const {
+        if (displacement & direct) {
+            return displacement & ~direct;
+        }
+        return slot(hash, displacement);
+    }
+
+    /**
+     * marks a displacement that is the slot itself
+     */
+    static constexpr std::uint32_t direct = 1u << 31;
+
+    /**
+     * most displacements tried per bucket before giving up
+     */
+    static constexpr std::uint32_t max_displacement = 1u << 16;
+
+    /**
+     * CHD with one bucket per key on average and a table without empty slots,
+     * then moves every entry to its slot
+     */
+    void build_perfect_hash(std::vector<std::pair<K, V>> &entries) {
+        const size_t count = entries.size();
+        if (count >= direct) {
+            throw std::length_error{"too many entries"};
+        }
+        table_size = count;
+        displacements.assign(count, 0);
+
+        std::vector<std::uint64_t> hashes(count);
+        std::vector<size_t> bucket_size(count);
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = hash_key(entries[i].first);
+            ++bucket_size[bucket(hashes[i])];
+            order[i] = i;
+        }
+
+        // keys of a bucket next to each other, largest buckets first while many slots are free
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+            size_t bucket_a = bucket(hashes[a]);
+            size_t bucket_b = bucket(hashes[b]);
+            if (bucket_size[bucket_a] != bucket_size[bucket_b]) {
+                return bucket_size[bucket_a] > bucket_size[bucket_b];
+            }
+            return bucket_a < bucket_b;
+        });
+
+        std::vector<bool> taken(count);
+        std::vector<size_t> source(count);
+        size_t first = 0;
+        while (first < count && bucket_size[bucket(hashes[order[first]])] > 1) {
+            size_t b = bucket(hashes[order[first]]);
+            size_t last = first + bucket_size[b];
+            for (size_t i = first; i < last; ++i) {
+                for (size_t j = first; j < i; ++j) {
+                    if (hashes[order[i]] == hashes[order[j]]) {
+                        if (entries[order[i]].first == entries[order[j]].first) {
+                            throw std::invalid_argument{"keys duplicated"};
+                        }
+                        throw std::logic_error{"perfect hash construction failed: keys with equal hashes"};
+                    }
+                }
+            }
+            displacements[b] = find_displacement(hashes, order, first, last, taken);
+            for (size_t i = first; i < last; ++i) {
+                size_t s = slot(hashes[order[i]], displacements[b]);
+                taken[s] = true;
+                source[s] = order[i];
+            }
+            first = last;
+        }
+
+        // the rest are alone in their bucket and fill the free slots in order
+        size_t free = 0;
+        for (; first < count; ++first) {
+            while (taken[free]) {
+                ++free;
+            }
+            taken[free] = true;
+            source[free] = order[first];
+            displacements[bucket(hashes[order[first]])] = direct | static_cast<std::uint32_t>(free);
+        }
+
+        values.reserve(count);
+        for (size_t s = 0; s < count; ++s) {
+            values.push_back(std::move(entries[source[s]]));
+        }
+    }
+
+    /**
+     * the first displacement moving all keys in order[first, last) to distinct free slots
+     */
+    std::uint32_t find_displacement(const std::vector<std::uint64_t> &hashes, const std::vector<size_t> &order,
+                                    size_t first, size_t last, const std::vector<bool> &taken) const {
+        for (std::uint32_t displacement = 0; displacement < max_displacement; ++displacement) {
+            bool fits = true;
+            for (size_t i = first; i < last && fits; ++i) {
+                size_t s = slot(hashes[order[i]], displacement);
+                fits = !taken[s];
+                for (size_t j = first; j < i && fits; ++j) {
+                    fits = slot(hashes[order[j]], displacement) != s;
+                }
+            }
+            if (fits) {
+                return displacement;
+            }
+        }
+        throw std::logic_error{"perfect hash construction failed: no displacement found"};
+    }
+
+    std::vector<std::pair<K, V>> values;
+
+    /**
+     * per bucket, a displacement or a slot marked `direct`
+     */
+    std::vector<std::uint32_t> displacements;
+
+    /**
+     * number of slots and of buckets
+     */
+    size_t table_size = 0;
+
+    Hash hasher;
+};
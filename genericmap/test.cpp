@@ -1,6 +1,25 @@
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
+#include "constexprbimap.h"
 #include "constexprmap.h"
+#include "constexprrangemap.h"
+#include "frozenmap.h"
+
+/**
+ * 4000 sparse keys, too many for the SIMD probe, inserted out of order: key i is
+ * (i * 7919 % 4000) * 1000 - 2000000, its value the key divided by 1000
+ */
+template<size_t... I>
+constexpr auto create_sparse_map(std::index_sequence<I...>) {
+    constexpr auto key = [](size_t i) {
+        return static_cast<int>(i * 7919 % 4000) * 1000 - 2000000;
+    };
+    return create_cexpr_map<int, int>(std::make_pair(key(I), key(I) / 1000)...);
+}
 
 int main() {
     // test compiletime map at runtime
@@ -20,5 +39,83 @@ int main() {
     }
     std::cout << "map[13]: " << map.get(13) << std::endl;
 
+    // entries are sorted at compile time, lookups are a binary search
+    constexpr auto codes = create_cexpr_map<int, const char *>(
+        std::make_pair(404, "not found"),
+        std::make_pair(200, "ok"),
+        std::make_pair(500, "internal error"));
+    static_assert(codes.contains(500) && !codes.contains(201));
+    std::cout << "codes[404]: " << codes[404] << std::endl;
+
+    // large sparse key sets are a branchless binary search, at compile time and at runtime
+    constexpr auto sparse = create_sparse_map(std::make_index_sequence<4000>{});
+    static_assert(!decltype(sparse)::probed && !sparse.is_dense());
+    static_assert(sparse.get(-2000000) == -2000 && sparse.get(1999000) == 1999 && sparse.get(7000) == 7);
+    static_assert(!sparse.contains(-2000001) && !sparse.contains(1999001) && !sparse.contains(7001));
+    int sparse_errors = 0;
+    for (int key = -2001000; key <= 2000000; key += 500) {
+        bool hit = key % 1000 == 0 && key <= 1999000 && key >= -2000000;
+        if (sparse.contains(key) != hit || (hit && sparse.get(key) != key / 1000)) {
+            ++sparse_errors;
+        }
+    }
+    if (sparse_errors != 0) {
+        std::cout << "sparse map lookup not yet working :)" << std::endl;
+    }
+    std::cout << "sparse[-2000000]: " << sparse[-2000000] << ", sparse[1999000]: " << sparse[1999000] << std::endl;
+
+    // string keys are placed by a perfect hash, a lookup is one hash and one compare
+    using namespace std::string_view_literals;
+    constexpr auto keywords = create_cexpr_map<std::string_view, int>(
+        std::make_pair("select"sv, 1),
+        std::make_pair("from"sv, 2),
+        std::make_pair("where"sv, 3),
+        std::make_pair("and"sv, 4));
+    static_assert(keywords.get("where") == 3 && !keywords.contains("or"));
+    std::cout << "keywords[from]: " << keywords["from"] << std::endl;
+
+    // keys packed into a small range are indexed directly
+    constexpr auto opcodes = create_cexpr_map<int, const char *>(
+        std::make_pair(0x10, "load"),
+        std::make_pair(0x11, "store"),
+        std::make_pair(0x14, "jump"));
+    static_assert(opcodes.is_dense() && !opcodes.contains(0x12));
+    std::cout << "opcodes[0x14]: " << opcodes[0x14] << std::endl;
+
+    // small sparse key sets are compared with SIMD at runtime, a search at compile time
+    constexpr auto ports = create_cexpr_map<int, const char *>(
+        std::make_pair(443, "https"),
+        std::make_pair(22, "ssh"),
+        std::make_pair(8080, "http-alt"));
+    static_assert(decltype(ports)::probed && ports.contains(22));
+    std::cout << "ports[8080]: " << ports[8080] << std::endl;
+
+    // one table, lookups in both directions
+    constexpr auto instructions = create_cexpr_bimap<std::string_view, int>(
+        std::make_pair("push"sv, 1),
+        std::make_pair("pop"sv, 2),
+        std::make_pair("add"sv, 3));
+    static_assert(instructions.get("pop") == 2 && instructions.get_key(3) == "add");
+    std::cout << "instructions: push -> " << instructions["push"] << ", 2 -> " << instructions.get_key(2) << std::endl;
+
+    // ranges [low, high) instead of an if chain, overlapping ranges don't compile
+    constexpr auto sizes = create_cexpr_range_map<size_t, const char *>({
+        {0, 1024, "small"},
+        {1024, 1 << 20, "medium"},
+        {1 << 20, 1 << 30, "large"}});
+    static_assert(sizes.get(1024) == std::string_view{"medium"} && !sizes.contains(1 << 30));
+    std::cout << "sizes[4096]: " << sizes[4096] << std::endl;
+
+    // tables known only at runtime are built once and read-only afterwards
+    std::vector<std::pair<std::string, int>> settings;
+    for (int i = 0; i < 100; ++i) {
+        settings.emplace_back("option" + std::to_string(i), i * i);
+    }
+    FrozenMap<std::string, int> frozen(settings.begin(), settings.end());
+    if (frozen.size() != 100 || frozen.contains("option100")) {
+        std::cout << "frozen map not yet working :)" << std::endl;
+    }
+    std::cout << "frozen[option12]: " << frozen["option12"] << std::endl;
+
     return 0;
 }
@@ -0,0 +1,466 @@
+#include "lexer.h"
+#include "token.h"
+#include "validator.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * throughput benchmark and differential fuzzer for the validator engines.
+ *
+ * generates random SELECT queries from the grammar, mutates some of them into
+ * (mostly) invalid ones, checks that every engine gives the same answer and
+ * measures tokens/s and queries/s of each engine. results are printed as JSON.
+ *
+ * options: --queries N --max-columns N --max-conditions N --invalid-ratio R --rounds N --seed N
+ */
+
+namespace {
+
+enum class Kind {
+    Select, Identifier, From, Comma, Asterisks, Semicolon, Dot, As, Where, And, Comparison, Literal
+};
+
+/**
+ * generator output, turned into tokens or into query text
+ */
+struct Piece {
+    Kind kind;
+    std::string text;
+    sql::token::Comparison::Op op = sql::token::Comparison::Op::Equal;
+};
+
+using Query = std::vector<Piece>;
+
+
+struct Options {
+    std::size_t queries = 10000;
+    std::size_t max_columns = 8;
+    std::size_t max_conditions = 4;
+    double invalid_ratio = 0.5;
+    std::size_t rounds = 10;
+    std::uint64_t seed = 42;
+};
+
+
+class Generator {
+public:
+    Generator(const Options &options) : options_{options}, random_{options.seed} {}
+
+    Query valid() {
+        Query query;
+        query.push_back({Kind::Select, "SELECT"});
+
+        if (chance(0.2)) {
+            query.push_back({Kind::Asterisks, "*"});
+        } else {
+            std::size_t columns = pick(1, options_.max_columns);
+            for (std::size_t i = 0; i < columns; ++i) {
+                if (i > 0) {
+                    query.push_back({Kind::Comma, ","});
+                }
+                name(query, "col");
+                if (chance(0.3)) {
+                    if (chance(0.5)) {
+                        query.push_back({Kind::As, "AS"});
+                    }
+                    query.push_back({Kind::Identifier, identifier("alias")});
+                }
+            }
+        }
+
+        query.push_back({Kind::From, "FROM"});
+        query.push_back({Kind::Identifier, identifier("tab")});
+        if (chance(0.3)) {
+            if (chance(0.5)) {
+                query.push_back({Kind::As, "AS"});
+            }
+            query.push_back({Kind::Identifier, identifier("t")});
+        }
+
+        if (options_.max_conditions > 0 and chance(0.6)) {
+            query.push_back({Kind::Where, "WHERE"});
+            std::size_t conditions = pick(1, options_.max_conditions);
+            for (std::size_t i = 0; i < conditions; ++i) {
+                if (i > 0) {
+                    query.push_back({Kind::And, "AND"});
+                }
+                operand(query);
+                comparison(query);
+                operand(query);
+            }
+        }
+
+        query.push_back({Kind::Semicolon, ";"});
+        return query;
+    }
+
+    /**
+     * a valid query with one random edit; the result may still be valid by accident
+     */
+    Query mutated() {
+        Query query = valid();
+        std::size_t pos = pick(0, query.size() - 1);
+        switch (pick(0, 3)) {
+        case 0:
+            query.erase(query.begin() + static_cast<std::ptrdiff_t>(pos));
+            break;
+        case 1:
+            query.insert(query.begin() + static_cast<std::ptrdiff_t>(pos), any());
+            break;
+        case 2:
+            if (pos + 1 < query.size()) {
+                std::swap(query[pos], query[pos + 1]);
+            }
+            break;
+        default:
+            query[pos] = any();
+            break;
+        }
+        return query;
+    }
+
+    bool chance(double probability) {
+        return std::bernoulli_distribution{probability}(random_);
+    }
+
+private:
+    std::size_t pick(std::size_t min, std::size_t max) {
+        return std::uniform_int_distribution<std::size_t>{min, max}(random_);
+    }
+
+    std::string identifier(std::string_view prefix) {
+        std::string result{prefix};
+        result += std::to_string(pick(0, 63));
+        // identifiers are case insensitive, vary the spelling
+        if (chance(0.3)) {
+            for (auto &c : result) {
+                if (c >= 'a' and c <= 'z') {
+                    c = static_cast<char>(c - 'a' + 'A');
+                }
+            }
+        }
+        return result;
+    }
+
+    void name(Query &query, std::string_view prefix) {
+        if (chance(0.3)) {
+            query.push_back({Kind::Identifier, identifier("t")});
+            query.push_back({Kind::Dot, "."});
+        }
+        query.push_back({Kind::Identifier, identifier(prefix)});
+    }
+
+    void operand(Query &query) {
+        if (chance(0.5)) {
+            name(query, "col");
+        } else if (chance(0.5)) {
+            query.push_back({Kind::Literal, std::to_string(pick(0, 100000))});
+        } else {
+            // appended piece by piece, "'" + identifier("v") + "'" trips a false -Wrestrict in GCC 12
+            std::string text{"'"};
+            text += identifier("v");
+            text += '\'';
+            query.push_back({Kind::Literal, std::move(text)});
+        }
+    }
+
+    void comparison(Query &query) {
+        using Op = sql::token::Comparison::Op;
+        static const std::vector<std::pair<Op, std::string>> ops{
+            {Op::Equal, "="}, {Op::NotEqual, "<>"}, {Op::Less, "<"},
+            {Op::LessEqual, "<="}, {Op::Greater, ">"}, {Op::GreaterEqual, ">="},
+        };
+        const auto &[op, text] = ops[pick(0, ops.size() - 1)];
+        query.push_back({Kind::Comparison, text, op});
+    }
+
+    Piece any() {
+        switch (pick(0, 11)) {
+        case 0: return {Kind::Select, "SELECT"};
+        case 1: return {Kind::Identifier, identifier("col")};
+        case 2: return {Kind::From, "FROM"};
+        case 3: return {Kind::Comma, ","};
+        case 4: return {Kind::Asterisks, "*"};
+        case 5: return {Kind::Semicolon, ";"};
+        case 6: return {Kind::Dot, "."};
+        case 7: return {Kind::As, "AS"};
+        case 8: return {Kind::Where, "WHERE"};
+        case 9: return {Kind::And, "AND"};
+        case 10: return {Kind::Comparison, "=", sql::token::Comparison::Op::Equal};
+        default: return {Kind::Literal, "7"};
+        }
+    }
+
+    const Options &options_;
+    std::mt19937_64 random_;
+};
+
+
+std::vector<sql::Token> to_tokens(const Query &query) {
+    std::vector<sql::Token> tokens;
+    tokens.reserve(query.size());
+    for (const auto &piece : query) {
+        switch (piece.kind) {
+        case Kind::Select:     tokens.emplace_back(sql::token::Select{}); break;
+        case Kind::Identifier: tokens.emplace_back(sql::token::Identifier{piece.text}); break;
+        case Kind::From:       tokens.emplace_back(sql::token::From{}); break;
+        case Kind::Comma:      tokens.emplace_back(sql::token::Comma{}); break;
+        case Kind::Asterisks:  tokens.emplace_back(sql::token::Asterisks{}); break;
+        case Kind::Semicolon:  tokens.emplace_back(sql::token::Semicolon{}); break;
+        case Kind::Dot:        tokens.emplace_back(sql::token::Dot{}); break;
+        case Kind::As:         tokens.emplace_back(sql::token::As{}); break;
+        case Kind::Where:      tokens.emplace_back(sql::token::Where{}); break;
+        case Kind::And:        tokens.emplace_back(sql::token::And{}); break;
+        case Kind::Comparison: tokens.emplace_back(sql::token::Comparison{piece.op}); break;
+        case Kind::Literal:    tokens.emplace_back(sql::token::Literal{piece.text}); break;
+        }
+    }
+    return tokens;
+}
+
+
+std::string to_text(const Query &query, Generator &generator) {
+    std::string text;
+    for (const auto &piece : query) {
+        if (not text.empty()) {
+            text += generator.chance(0.1) ? "\n  " : " ";
+        }
+        text += piece.text;
+    }
+    return text;
+}
+
+
+/**
+ * reference engine: recursive descent written straight from the grammar,
+ * independent of the generated transition table
+ */
+class DescentParser {
+public:
+    explicit DescentParser(const std::vector<sql::Token> &tokens) : tokens_{tokens} {}
+
+    bool parse() {
+        if (not accept<sql::token::Select>()) {
+            return false;
+        }
+        if (not accept<sql::token::Asterisks>()) {
+            do {
+                if (not column()) {
+                    return false;
+                }
+            } while (accept<sql::token::Comma>());
+        }
+        if (not accept<sql::token::From>() or not accept<sql::token::Identifier>()) {
+            return false;
+        }
+        if (not alias()) {
+            return false;
+        }
+        if (accept<sql::token::Where>()) {
+            do {
+                if (not operand() or not accept<sql::token::Comparison>() or not operand()) {
+                    return false;
+                }
+            } while (accept<sql::token::And>());
+        }
+        if (not accept<sql::token::Semicolon>()) {
+            return false;
+        }
+        while (accept<sql::token::Semicolon>()) {}
+        return pos_ == tokens_.size();
+    }
+
+private:
+    template<typename T>
+    bool accept() {
+        if (pos_ < tokens_.size() and std::holds_alternative<T>(tokens_[pos_].value())) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    bool qualified_name() {
+        if (not accept<sql::token::Identifier>()) {
+            return false;
+        }
+        return not accept<sql::token::Dot>() or accept<sql::token::Identifier>();
+    }
+
+    bool alias() {
+        if (accept<sql::token::As>()) {
+            return accept<sql::token::Identifier>();
+        }
+        accept<sql::token::Identifier>();
+        return true;
+    }
+
+    bool column() {
+        return qualified_name() and alias();
+    }
+
+    bool operand() {
+        return accept<sql::token::Literal>() or qualified_name();
+    }
+
+    const std::vector<sql::Token> &tokens_;
+    std::size_t pos_ = 0;
+};
+
+
+struct Corpus {
+    std::vector<std::vector<sql::Token>> tokens;
+    std::vector<std::string> texts;
+    std::vector<bool> generated_valid;
+    std::size_t token_count = 0;
+};
+
+
+struct Engine {
+    std::string name;
+    std::function<bool(const Corpus &, std::size_t)> validate;
+};
+
+
+// not bench::parse_options, the validator's flags are its own and --invalid-ratio is fractional
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; i += 2) {
+        std::string_view flag{argv[i]};
+        // asked for only once the flag is known, so an unknown last flag isn't reported as missing a value
+        auto value = [&]() -> std::string {
+            if (i + 1 == argc) {
+                throw std::invalid_argument{"missing value for " + std::string{flag}};
+            }
+            return argv[i + 1];
+        };
+        if (flag == "--queries") {
+            options.queries = std::stoull(value());
+        } else if (flag == "--max-columns") {
+            options.max_columns = std::stoull(value());
+        } else if (flag == "--max-conditions") {
+            options.max_conditions = std::stoull(value());
+        } else if (flag == "--invalid-ratio") {
+            options.invalid_ratio = std::stod(value());
+        } else if (flag == "--rounds") {
+            options.rounds = std::stoull(value());
+        } else if (flag == "--seed") {
+            options.seed = std::stoull(value());
+        } else {
+            throw std::invalid_argument{"unknown option: " + std::string{flag}};
+        }
+    }
+    if (options.max_columns == 0) {
+        throw std::invalid_argument{"--max-columns must be at least 1"};
+    }
+    // also rejects NaN, std::bernoulli_distribution needs a probability
+    if (not (options.invalid_ratio >= 0.0 and options.invalid_ratio <= 1.0)) {
+        throw std::invalid_argument{"--invalid-ratio must be between 0 and 1"};
+    }
+    return options;
+}
+
+} // namespace
+
+
+int main(int argc, char **argv) {
+    Options options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (std::exception &err) {
+        std::cerr << err.what() << std::endl;
+        return 2;
+    }
+
+    Generator generator{options};
+    Corpus corpus;
+    for (std::size_t i = 0; i < options.queries; ++i) {
+        bool valid = not generator.chance(options.invalid_ratio);
+        Query query = valid ? generator.valid() : generator.mutated();
+        corpus.token_count += query.size();
+        corpus.tokens.push_back(to_tokens(query));
+        corpus.texts.push_back(to_text(query, generator));
+        corpus.generated_valid.push_back(valid);
+    }
+
+    sql::ValidationCache cache{options.queries * 2};
+    std::vector<Engine> engines{
+        {"descent", [](const Corpus &c, std::size_t i) { return DescentParser{c.tokens[i]}.parse(); }},
+        {"fsm", [](const Corpus &c, std::size_t i) { return sql::is_valid_sql_query(c.tokens[i]); }},
+        {"lexer+fsm", [](const Corpus &c, std::size_t i) {
+            auto lexed = sql::tokenize(c.texts[i]);
+            return lexed.complete and sql::is_valid_sql_query(lexed.tokens);
+        }},
+        {"cached", [&cache](const Corpus &c, std::size_t i) { return sql::is_valid_sql_query(c.texts[i], cache); }},
+    };
+
+    // differential check: all engines agree, generated valid queries are accepted
+    std::size_t disagreements = 0;
+    std::size_t rejected_valid = 0;
+    std::size_t accepted = 0;
+    for (std::size_t i = 0; i < options.queries; ++i) {
+        bool expected = engines.front().validate(corpus, i);
+        accepted += expected ? 1 : 0;
+        if (corpus.generated_valid[i] and not expected) {
+            ++rejected_valid;
+            std::cerr << "valid query rejected: " << corpus.texts[i] << std::endl;
+        }
+        for (const auto &engine : engines) {
+            if (engine.validate(corpus, i) != expected) {
+                ++disagreements;
+                std::cerr << engine.name << " disagrees on: " << corpus.texts[i] << std::endl;
+            }
+        }
+    }
+
+    std::cout << "{\n"
+              << "  \"queries\": " << options.queries << ",\n"
+              << "  \"tokens\": " << corpus.token_count << ",\n"
+              << "  \"accepted\": " << accepted << ",\n"
+              << "  \"rounds\": " << options.rounds << ",\n"
+              << "  \"seed\": " << options.seed << ",\n"
+              << "  \"disagreements\": " << disagreements << ",\n"
+              << "  \"rejected_valid\": " << rejected_valid << ",\n"
+              << "  \"engines\": [\n";
+
+    for (std::size_t e = 0; e < engines.size(); ++e) {
+        const auto &engine = engines[e];
+        std::size_t valid_count = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t round = 0; round < options.rounds; ++round) {
+            for (std::size_t i = 0; i < options.queries; ++i) {
+                valid_count += engine.validate(corpus, i) ? 1 : 0;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double seconds = elapsed.count() > 0 ? elapsed.count() : 1e-9;
+        double queries = static_cast<double>(options.queries * options.rounds);
+        double tokens = static_cast<double>(corpus.token_count * options.rounds);
+
+        std::cout << "    {\"name\": \"" << engine.name << "\""
+                  << ", \"seconds\": " << elapsed.count()
+                  << ", \"queries_per_sec\": " << queries / seconds
+                  << ", \"tokens_per_sec\": " << tokens / seconds
+                  << ", \"accepted\": " << valid_count
+                  << "}" << (e + 1 < engines.size() ? "," : "") << "\n";
+    }
+
+    auto stats = cache.stats();
+    std::cout << "  ],\n"
+              << "  \"cache\": {\"hits\": " << stats.hits << ", \"misses\": " << stats.misses
+              << ", \"evictions\": " << stats.evictions << "}\n"
+              << "}" << std::endl;
+
+    return (disagreements == 0 and rejected_valid == 0) ? 0 : 1;
+}
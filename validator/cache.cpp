@@ -0,0 +1,87 @@
+#include "cache.h"
+
+#include <algorithm>
+
+namespace sql {
+
+namespace {
+
+// entries store the key with its lowest bit replaced by the result, 0 marks an empty way.
+// bit 0 of the key is lost, see the class comment
+constexpr std::uint64_t key_mask = ~std::uint64_t{1};
+
+constexpr std::uint64_t tag(std::uint64_t key) {
+    // keys that would look like an empty way are moved aside
+    std::uint64_t tagged = key & key_mask;
+    return tagged == 0 ? 2 : tagged;
+}
+
+} // namespace
+
+
+ValidationCache::ValidationCache(std::size_t capacity)
+    : shard_count_{std::max<std::size_t>(1, (capacity + ways - 1) / ways)},
+      shards_{std::make_unique<Shard[]>(shard_count_)} {}
+
+
+std::size_t ValidationCache::shard_index(std::uint64_t key) const {
+    // the low bits go into the tag, use the high ones for the shard
+    return static_cast<std::size_t>((key >> 32) % shard_count_);
+}
+
+
+std::optional<bool> ValidationCache::find(std::uint64_t key) {
+    std::size_t index = shard_index(key);
+    auto &counters = counters_[index % counter_stripes];
+    std::uint64_t wanted = tag(key);
+
+    for (auto &entry : shards_[index].entries) {
+        std::uint64_t stored = entry.load(std::memory_order_relaxed);
+        if ((stored & key_mask) == wanted) {
+            counters.hits.fetch_add(1, std::memory_order_relaxed);
+            return (stored & 1) != 0;
+        }
+    }
+    counters.misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+
+void ValidationCache::insert(std::uint64_t key, bool valid) {
+    std::size_t index = shard_index(key);
+    auto &counters = counters_[index % counter_stripes];
+    auto &entries = shards_[index].entries;
+    std::uint64_t wanted = tag(key);
+    std::uint64_t value = wanted | (valid ? 1 : 0);
+
+    for (auto &entry : entries) {
+        std::uint64_t stored = entry.load(std::memory_order_relaxed);
+        if ((stored & key_mask) == wanted) {
+            // another thread already cached it
+            return;
+        }
+        if (stored == 0 and entry.compare_exchange_strong(stored, value, std::memory_order_relaxed)) {
+            counters.insertions.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    // shard is full, the key picks the victim
+    entries[(key >> 8) % ways].store(value, std::memory_order_relaxed);
+    counters.insertions.fetch_add(1, std::memory_order_relaxed);
+    counters.evictions.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+ValidationCache::Stats ValidationCache::stats() const {
+    Stats total;
+    for (const auto &counters : counters_) {
+        total.hits += counters.hits.load(std::memory_order_relaxed);
+        total.misses += counters.misses.load(std::memory_order_relaxed);
+        total.insertions += counters.insertions.load(std::memory_order_relaxed);
+        total.evictions += counters.evictions.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+} // namespace sql
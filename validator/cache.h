@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace sql {
+
+/**
+ * bounded cache of validation results keyed by query fingerprint, safe to share between threads.
+ *
+ * entries are split into shards of one cache line each (8 ways), the shard is picked by the key.
+ * every entry is a single atomic word holding the key and the result, so lookups and
+ * inserts never lock. a full shard replaces a way chosen by the key.
+ *
+ * the result takes the lowest bit of the word, so only the upper 63 bits of a key are compared:
+ * keys differing only in bit 0 share an entry (and keys 0 to 3 share one, 0 marks an empty way).
+ * with 64 bit hashes as keys that is one more bit of collision chance and is accepted.
+ */
+class ValidationCache {
+public:
+    /**
+     * @param capacity: upper bound of cached results, rounded up to whole shards
+     */
+    explicit ValidationCache(std::size_t capacity);
+
+    ValidationCache(const ValidationCache &) = delete;
+
+    ValidationCache &operator=(const ValidationCache &) = delete;
+
+    /**
+     * cached validity of a query, empty on a miss
+     */
+    [[nodiscard]]
+    std::optional<bool> find(std::uint64_t key);
+
+    void insert(std::uint64_t key, bool valid);
+
+    [[nodiscard]]
+    std::size_t capacity() const { return shard_count_ * ways; }
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t insertions = 0;
+        std::uint64_t evictions = 0;
+    };
+
+    /**
+     * counters summed over all threads, only approximately consistent while the cache is in use
+     */
+    [[nodiscard]]
+    Stats stats() const;
+
+private:
+    static constexpr std::size_t ways = 8;
+
+    static constexpr std::size_t counter_stripes = 16;
+
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, ways> entries{};
+    };
+
+    // counters are striped so threads working on different shards don't share a cache line
+    struct alignas(64) Counters {
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+        std::atomic<std::uint64_t> insertions{0};
+        std::atomic<std::uint64_t> evictions{0};
+    };
+
+    [[nodiscard]]
+    std::size_t shard_index(std::uint64_t key) const;
+
+    std::size_t shard_count_;
+
+    std::unique_ptr<Shard[]> shards_;
+
+    std::array<Counters, counter_stripes> counters_;
+};
+
+} // namespace sql
@@ -0,0 +1,316 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "state.h"
+#include "token.h"
+
+namespace sql::grammar {
+
+namespace detail {
+
+/**
+ * position of `T` in the alternatives of a variant, `sizeof...(Ts)` if it is missing
+ */
+template<typename T, typename... Ts>
+constexpr std::size_t index_in(const std::variant<Ts...> *) {
+    constexpr std::array<bool, sizeof...(Ts)> matches{std::is_same_v<T, Ts>...};
+    std::size_t index = 0;
+    while (index < matches.size() and not matches[index]) {
+        ++index;
+    }
+    return index;
+}
+
+template<typename T, typename Variant>
+inline constexpr std::size_t index_of = index_in<T>(static_cast<const Variant *>(nullptr));
+
+} // namespace detail
+
+
+using state_id = std::uint8_t;
+
+inline constexpr std::size_t state_count = std::variant_size_v<State>;
+
+inline constexpr std::size_t token_count = std::variant_size_v<Token::token_type>;
+
+static_assert(state_count <= 256, "state ids have to fit into state_id");
+
+
+template<typename S>
+requires (detail::index_of<S, State> < state_count)
+inline constexpr auto state_index = static_cast<state_id>(detail::index_of<S, State>);
+
+template<typename T>
+requires (detail::index_of<T, Token::token_type> < token_count)
+inline constexpr std::size_t token_index = detail::index_of<T, Token::token_type>;
+
+
+/**
+ * what a transition records for schema checks, only evaluated when a schema is attached
+ */
+enum class Action : std::uint8_t {
+    None,
+    Column,         // identifier is a column reference
+    Qualify,        // `.` turns the last column reference into a qualifier
+    QualifiedName,  // identifier is the column name after a qualifier
+    Table,          // identifier is the table name
+    TableAlias,     // identifier is the alias of the table
+    Resolve,        // query is complete, check all references against the schema
+};
+
+
+/**
+ * one edge of the FSM: in state `from`, the token `token` moves to state `to`
+ */
+struct Rule {
+    state_id from;
+    std::size_t token;
+    state_id to;
+    Action action = Action::None;
+};
+
+template<typename From, typename Tok, typename To, Action action = Action::None>
+constexpr Rule rule() {
+    return {state_index<From>, token_index<Tok>, state_index<To>, action};
+}
+
+
+/**
+ * the SELECT grammar; every (state, token) pair not listed here leads to `Invalid`
+ *
+ * SELECT ( * | column [, column]* ) FROM table [[AS] alias] [WHERE condition [AND condition]*] ;
+ *   column    := name[.name] [[AS] alias]
+ *   condition := operand comparison operand
+ *   operand   := name[.name] | literal
+ */
+inline constexpr std::array rules{
+    rule<state::Start,           token::Select,     state::SelectStmt>(),
+
+    rule<state::SelectStmt,      token::Asterisks,  state::AllColumns>(),
+    rule<state::SelectStmt,      token::Identifier, state::NamedColumn,     Action::Column>(),
+    rule<state::AllColumns,      token::From,       state::FromClause>(),
+
+    rule<state::NamedColumn,     token::Dot,        state::ColumnQualifier, Action::Qualify>(),
+    rule<state::NamedColumn,     token::As,         state::ColumnAs>(),
+    rule<state::NamedColumn,     token::Identifier, state::AliasedColumn>(),
+    rule<state::NamedColumn,     token::Comma,      state::MoreColumns>(),
+    rule<state::NamedColumn,     token::From,       state::FromClause>(),
+    rule<state::ColumnQualifier, token::Identifier, state::QualifiedColumn, Action::QualifiedName>(),
+    rule<state::QualifiedColumn, token::As,         state::ColumnAs>(),
+    rule<state::QualifiedColumn, token::Identifier, state::AliasedColumn>(),
+    rule<state::QualifiedColumn, token::Comma,      state::MoreColumns>(),
+    rule<state::QualifiedColumn, token::From,       state::FromClause>(),
+    rule<state::ColumnAs,        token::Identifier, state::AliasedColumn>(),
+    rule<state::AliasedColumn,   token::Comma,      state::MoreColumns>(),
+    rule<state::AliasedColumn,   token::From,       state::FromClause>(),
+    rule<state::MoreColumns,     token::Identifier, state::NamedColumn,     Action::Column>(),
+
+    rule<state::FromClause,      token::Identifier, state::TableName,       Action::Table>(),
+    rule<state::TableName,       token::As,         state::TableAs>(),
+    rule<state::TableName,       token::Identifier, state::AliasedTable,    Action::TableAlias>(),
+    rule<state::TableName,       token::Where,      state::WhereClause>(),
+    rule<state::TableName,       token::Semicolon,  state::Valid,           Action::Resolve>(),
+    rule<state::TableAs,         token::Identifier, state::AliasedTable,    Action::TableAlias>(),
+    rule<state::AliasedTable,    token::Where,      state::WhereClause>(),
+    rule<state::AliasedTable,    token::Semicolon,  state::Valid,           Action::Resolve>(),
+
+    rule<state::WhereClause,     token::Identifier, state::LeftColumn,      Action::Column>(),
+    rule<state::WhereClause,     token::Literal,    state::LeftOperand>(),
+    rule<state::LeftColumn,      token::Dot,        state::LeftQualifier,   Action::Qualify>(),
+    rule<state::LeftColumn,      token::Comparison, state::ComparisonOp>(),
+    rule<state::LeftQualifier,   token::Identifier, state::LeftOperand,     Action::QualifiedName>(),
+    rule<state::LeftOperand,     token::Comparison, state::ComparisonOp>(),
+    rule<state::ComparisonOp,    token::Identifier, state::RightColumn,     Action::Column>(),
+    rule<state::ComparisonOp,    token::Literal,    state::Condition>(),
+    rule<state::RightColumn,     token::Dot,        state::RightQualifier,  Action::Qualify>(),
+    rule<state::RightColumn,     token::And,        state::WhereClause>(),
+    rule<state::RightColumn,     token::Semicolon,  state::Valid,           Action::Resolve>(),
+    rule<state::RightQualifier,  token::Identifier, state::Condition,       Action::QualifiedName>(),
+    rule<state::Condition,       token::And,        state::WhereClause>(),
+    rule<state::Condition,       token::Semicolon,  state::Valid,           Action::Resolve>(),
+
+    // trailing semicolons keep a finished query valid
+    rule<state::Valid,           token::Semicolon,  state::Valid>(),
+};
+
+
+inline constexpr state_id start = state_index<state::Start>;
+
+inline constexpr state_id invalid = state_index<state::Invalid>;
+
+inline constexpr state_id valid = state_index<state::Valid>;
+
+
+/**
+ * one cell of the generated table
+ */
+struct Transition {
+    state_id next;
+    Action action;
+};
+
+/**
+ * transition for every (state, token index) pair
+ */
+using Table = std::array<std::array<Transition, token_count>, state_count>;
+
+
+template<std::size_t N>
+constexpr Table build_table(const std::array<Rule, N> &grammar) {
+    Table table{};
+    for (auto &row : table) {
+        row.fill({invalid, Action::None});
+    }
+    for (const auto &r : grammar) {
+        table[r.from][r.token] = {r.to, r.action};
+    }
+    return table;
+}
+
+
+/**
+ * no (state, token) pair may have more than one rule
+ */
+template<std::size_t N>
+constexpr bool is_deterministic(const std::array<Rule, N> &grammar) {
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = i + 1; j < N; ++j) {
+            if (grammar[i].from == grammar[j].from and grammar[i].token == grammar[j].token) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * once invalid, the FSM must never recover
+ */
+template<std::size_t N>
+constexpr bool invalid_is_absorbing(const std::array<Rule, N> &grammar) {
+    for (const auto &r : grammar) {
+        if (r.from == invalid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * actions only appear on tokens they can work with:
+ * names on identifiers, qualifying on dots and resolving when entering `Valid`
+ */
+template<std::size_t N>
+constexpr bool actions_fit_tokens(const std::array<Rule, N> &grammar) {
+    for (const auto &r : grammar) {
+        switch (r.action) {
+        case Action::None:
+            break;
+        case Action::Column:
+        case Action::QualifiedName:
+        case Action::Table:
+        case Action::TableAlias:
+            if (r.token != token_index<token::Identifier>) {
+                return false;
+            }
+            break;
+        case Action::Qualify:
+            if (r.token != token_index<token::Dot>) {
+                return false;
+            }
+            break;
+        case Action::Resolve:
+            if (r.to != valid) {
+                return false;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+
+namespace detail {
+
+/**
+ * fixpoint over the rules: marks every state connected to `origin`,
+ * following the edges forward or backward
+ */
+template<std::size_t N>
+constexpr std::array<bool, state_count> connected(const std::array<Rule, N> &grammar, state_id origin, bool forward) {
+    std::array<bool, state_count> seen{};
+    seen[origin] = true;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto &r : grammar) {
+            state_id known = forward ? r.from : r.to;
+            state_id other = forward ? r.to : r.from;
+            if (seen[known] and not seen[other]) {
+                seen[other] = true;
+                changed = true;
+            }
+        }
+    }
+    return seen;
+}
+
+} // namespace detail
+
+
+/**
+ * every state except `Invalid` can be entered from `Start`
+ */
+template<std::size_t N>
+constexpr bool all_states_reachable(const std::array<Rule, N> &grammar) {
+    auto seen = detail::connected(grammar, start, true);
+    for (std::size_t s = 0; s < state_count; ++s) {
+        if (s != invalid and not seen[s]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * every state except `Invalid` can still end up in `Valid`
+ */
+template<std::size_t N>
+constexpr bool all_states_can_accept(const std::array<Rule, N> &grammar) {
+    auto seen = detail::connected(grammar, valid, false);
+    for (std::size_t s = 0; s < state_count; ++s) {
+        if (s != invalid and not seen[s]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static_assert(is_deterministic(rules), "grammar is ambiguous: a (state, token) pair has several rules");
+static_assert(invalid_is_absorbing(rules), "grammar must not leave the Invalid state");
+static_assert(all_states_reachable(rules), "grammar has states that can't be reached from Start");
+static_assert(all_states_can_accept(rules), "grammar has states that can never reach Valid");
+static_assert(actions_fit_tokens(rules), "grammar attaches an action to a token it can't handle");
+
+
+inline constexpr Table transitions = build_table(rules);
+
+
+/**
+ * `State` alternative for each state id
+ */
+inline constexpr auto states = []<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<State, state_count>{State{std::in_place_index<I>}...};
+}(std::make_index_sequence<state_count>{});
+
+} // namespace sql::grammar
@@ -0,0 +1,234 @@
+#include "lexer.h"
+
+#include <array>
+#include <utility>
+
+namespace sql {
+
+namespace {
+
+enum class Kind : std::uint8_t {
+    Select, Identifier, From, Comma, Asterisks, Semicolon, Dot, As, Where, And, Comparison, Literal, Unknown
+};
+
+constexpr char fold(char c) {
+    return (c >= 'A' and c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool is_space(char c) {
+    return c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\f' or c == '\v';
+}
+
+constexpr bool is_digit(char c) {
+    return c >= '0' and c <= '9';
+}
+
+constexpr bool is_name_start(char c) {
+    return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or c == '_';
+}
+
+constexpr bool is_name_char(char c) {
+    return is_name_start(c) or is_digit(c);
+}
+
+constexpr bool equals_folded(std::string_view word, std::string_view keyword) {
+    if (word.size() != keyword.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < word.size(); ++i) {
+        if (fold(word[i]) != keyword[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr Kind classify_word(std::string_view word) {
+    constexpr std::array<std::pair<std::string_view, Kind>, 5> keywords{{
+        {"select", Kind::Select}, {"from", Kind::From}, {"where", Kind::Where}, {"and", Kind::And}, {"as", Kind::As},
+    }};
+    for (const auto &[keyword, kind] : keywords) {
+        if (equals_folded(word, keyword)) {
+            return kind;
+        }
+    }
+    return Kind::Identifier;
+}
+
+/**
+ * walks the query once and reports every token as (kind, text, comparison) to `sink`
+ * stops at the first character that doesn't start a token and reports it as `Unknown`
+ */
+template<typename Sink>
+bool scan(std::string_view query, Sink &&sink) {
+    using Op = token::Comparison::Op;
+
+    std::size_t pos = 0;
+    while (pos < query.size()) {
+        char c = query[pos];
+        std::size_t start = pos;
+
+        if (is_space(c)) {
+            ++pos;
+            continue;
+        }
+
+        if (is_name_start(c)) {
+            while (pos < query.size() and is_name_char(query[pos])) {
+                ++pos;
+            }
+            auto word = query.substr(start, pos - start);
+            sink(classify_word(word), word, Op::Equal);
+            continue;
+        }
+
+        if (is_digit(c)) {
+            while (pos < query.size() and (is_digit(query[pos]) or query[pos] == '.')) {
+                ++pos;
+            }
+            sink(Kind::Literal, query.substr(start, pos - start), Op::Equal);
+            continue;
+        }
+
+        if (c == '\'') {
+            // '' inside a string is an escaped quote
+            ++pos;
+            while (true) {
+                if (pos >= query.size()) {
+                    sink(Kind::Unknown, query.substr(start), Op::Equal);
+                    return false;
+                }
+                if (query[pos] == '\'') {
+                    if (pos + 1 < query.size() and query[pos + 1] == '\'') {
+                        pos += 2;
+                        continue;
+                    }
+                    ++pos;
+                    break;
+                }
+                ++pos;
+            }
+            sink(Kind::Literal, query.substr(start, pos - start), Op::Equal);
+            continue;
+        }
+
+        char next = pos + 1 < query.size() ? query[pos + 1] : '\0';
+        ++pos;
+        switch (c) {
+        case ',': sink(Kind::Comma, query.substr(start, 1), Op::Equal); break;
+        case ';': sink(Kind::Semicolon, query.substr(start, 1), Op::Equal); break;
+        case '.': sink(Kind::Dot, query.substr(start, 1), Op::Equal); break;
+        case '*': sink(Kind::Asterisks, query.substr(start, 1), Op::Equal); break;
+        case '=': sink(Kind::Comparison, query.substr(start, 1), Op::Equal); break;
+        case '<':
+            if (next == '=') {
+                sink(Kind::Comparison, query.substr(start, ++pos - start), Op::LessEqual);
+            } else if (next == '>') {
+                sink(Kind::Comparison, query.substr(start, ++pos - start), Op::NotEqual);
+            } else {
+                sink(Kind::Comparison, query.substr(start, 1), Op::Less);
+            }
+            break;
+        case '>':
+            if (next == '=') {
+                sink(Kind::Comparison, query.substr(start, ++pos - start), Op::GreaterEqual);
+            } else {
+                sink(Kind::Comparison, query.substr(start, 1), Op::Greater);
+            }
+            break;
+        case '!':
+            if (next == '=') {
+                sink(Kind::Comparison, query.substr(start, ++pos - start), Op::NotEqual);
+                break;
+            }
+            [[fallthrough]];
+        default:
+            sink(Kind::Unknown, query.substr(start, 1), Op::Equal);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * FNV-1a over kind, comparison and normalized text of each token
+ */
+class Fingerprint {
+public:
+    void add(Kind kind, std::string_view text, token::Comparison::Op op) {
+        byte(static_cast<std::uint8_t>(kind));
+        switch (kind) {
+        case Kind::Identifier:
+            for (char c : text) {
+                byte(static_cast<std::uint8_t>(fold(c)));
+            }
+            byte(0xff);
+            break;
+        case Kind::Literal:
+        case Kind::Unknown:
+            for (char c : text) {
+                byte(static_cast<std::uint8_t>(c));
+            }
+            byte(0xff);
+            break;
+        case Kind::Comparison:
+            byte(static_cast<std::uint8_t>(op));
+            break;
+        default:
+            break;
+        }
+    }
+
+    [[nodiscard]]
+    std::uint64_t value() const { return hash_; }
+
+private:
+    void byte(std::uint8_t value) {
+        hash_ ^= value;
+        hash_ *= 1099511628211ull;
+    }
+
+    std::uint64_t hash_ = 14695981039346656037ull;
+};
+
+} // namespace
+
+
+LexResult tokenize(std::string_view query) {
+    LexResult result;
+    Fingerprint hash;
+
+    result.complete = scan(query, [&](Kind kind, std::string_view text, token::Comparison::Op op) {
+        hash.add(kind, text, op);
+        switch (kind) {
+        case Kind::Select:     result.tokens.emplace_back(token::Select{}); break;
+        case Kind::Identifier: result.tokens.emplace_back(token::Identifier{text}); break;
+        case Kind::From:       result.tokens.emplace_back(token::From{}); break;
+        case Kind::Comma:      result.tokens.emplace_back(token::Comma{}); break;
+        case Kind::Asterisks:  result.tokens.emplace_back(token::Asterisks{}); break;
+        case Kind::Semicolon:  result.tokens.emplace_back(token::Semicolon{}); break;
+        case Kind::Dot:        result.tokens.emplace_back(token::Dot{}); break;
+        case Kind::As:         result.tokens.emplace_back(token::As{}); break;
+        case Kind::Where:      result.tokens.emplace_back(token::Where{}); break;
+        case Kind::And:        result.tokens.emplace_back(token::And{}); break;
+        case Kind::Comparison: result.tokens.emplace_back(token::Comparison{op}); break;
+        case Kind::Literal:    result.tokens.emplace_back(token::Literal{std::string{text}}); break;
+        case Kind::Unknown:    break;
+        }
+    });
+
+    result.fingerprint = hash.value();
+    return result;
+}
+
+
+std::uint64_t fingerprint(std::string_view query) {
+    Fingerprint hash;
+    scan(query, [&hash](Kind kind, std::string_view text, token::Comparison::Op op) {
+        hash.add(kind, text, op);
+    });
+    return hash.value();
+}
+
+} // namespace sql
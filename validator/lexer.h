@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "token.h"
+
+namespace sql {
+
+/**
+ * tokens of a query and its fingerprint
+ */
+struct LexResult {
+    std::vector<Token> tokens;
+
+    std::uint64_t fingerprint = 0;
+
+    /**
+     * false if the query contains characters that don't form a token
+     */
+    bool complete = true;
+};
+
+
+/**
+ * split a query text into tokens and compute its fingerprint in the same pass.
+ * keywords and identifiers are case insensitive, literals are numbers or 'quoted' strings.
+ * identifiers are only looked up in the symbol table, unknown names get `no_symbol`.
+ */
+[[nodiscard]]
+LexResult tokenize(std::string_view query);
+
+
+/**
+ * 64 bit hash of the token sequence, without building the tokens, same as `LexResult::fingerprint`.
+ * queries differing only in whitespace or keyword/identifier case have the same fingerprint.
+ */
+[[nodiscard]]
+std::uint64_t fingerprint(std::string_view query);
+
+} // namespace sql
@@ -0,0 +1,188 @@
+#include "schema.h"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace sql {
+
+namespace {
+
+/**
+ * splitmix64 finalizer
+ */
+constexpr std::uint64_t mix(std::uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+constexpr std::uint64_t golden = 0x9e3779b97f4a7c15ull;
+
+// tried displacements per bucket before a new seed is picked
+constexpr std::uint32_t max_displacement = 1u << 16;
+
+constexpr std::uint64_t max_seed_attempts = 64;
+
+std::atomic<std::uint64_t> next_generation{1};
+
+} // namespace
+
+
+Schema::Schema(const std::vector<TableDefinition> &tables)
+    : generation_{next_generation.fetch_add(1, std::memory_order_relaxed)} {
+    auto &symbols = SymbolTable::global();
+
+    std::vector<std::uint64_t> keys;
+    for (const auto &table : tables) {
+        symbol_t name = symbols.intern(table.name);
+        if (name >= tables_.size()) {
+            tables_.resize(static_cast<std::size_t>(name) + 1, no_table);
+        }
+        if (tables_[name] != no_table) {
+            throw schema_error{"table defined twice: " + table.name};
+        }
+        auto number = static_cast<std::uint32_t>(table_count_++);
+        tables_[name] = number;
+
+        for (const auto &column : table.columns) {
+            keys.push_back((std::uint64_t{number} << 32) | symbols.intern(column));
+        }
+    }
+
+    std::sort(keys.begin(), keys.end());
+    if (std::adjacent_find(keys.begin(), keys.end()) != keys.end()) {
+        throw schema_error{"column defined twice"};
+    }
+    column_count_ = keys.size();
+
+    build_column_index(keys);
+}
+
+
+Schema Schema::parse(std::istream &input) {
+    std::vector<TableDefinition> tables;
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream words{line};
+        TableDefinition table;
+        if (not (words >> table.name) or table.name.front() == '#') {
+            continue;
+        }
+        std::string column;
+        while (words >> column) {
+            table.columns.push_back(std::move(column));
+        }
+        tables.push_back(std::move(table));
+    }
+    if (input.bad()) {
+        throw schema_error{"reading schema failed"};
+    }
+    return Schema{tables};
+}
+
+
+Schema Schema::load(const std::string &path) {
+    std::ifstream file{path};
+    if (not file) {
+        throw schema_error{"can't open schema file: " + path};
+    }
+    return parse(file);
+}
+
+
+bool Schema::has_table(symbol_t table) const {
+    return table_slot(table) != no_table;
+}
+
+
+bool Schema::has_column(symbol_t table, symbol_t column) const {
+    std::uint32_t number = table_slot(table);
+    if (number == no_table or columns_.empty()) {
+        return false;
+    }
+    std::uint64_t key = (std::uint64_t{number} << 32) | column;
+    return columns_[column_slot(key)] == key;
+}
+
+
+std::uint32_t Schema::table_slot(symbol_t table) const {
+    return table < tables_.size() ? tables_[table] : no_table;
+}
+
+
+std::size_t Schema::column_slot(std::uint64_t key) const {
+    std::uint64_t hash = mix(key ^ seed_);
+    std::uint32_t displacement = displacements_[(hash >> 32) % displacements_.size()];
+    return mix(hash + displacement * golden) % columns_.size();
+}
+
+
+void Schema::build_column_index(const std::vector<std::uint64_t> &keys) {
+    if (keys.empty()) {
+        return;
+    }
+
+    std::size_t slot_count = keys.size() + keys.size() / 4 + 1;
+    std::size_t bucket_count = keys.size() / 4 + 1;
+
+    for (std::uint64_t attempt = 0; attempt < max_seed_attempts; ++attempt) {
+        seed_ = mix(attempt + golden);
+        displacements_.assign(bucket_count, 0);
+        columns_.assign(slot_count, empty_slot);
+
+        std::vector<std::vector<std::uint64_t>> buckets(bucket_count);
+        for (auto key : keys) {
+            buckets[(mix(key ^ seed_) >> 32) % bucket_count].push_back(key);
+        }
+
+        // place the largest buckets first while most slots are still free
+        std::vector<std::size_t> order(bucket_count);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&buckets](auto lhs, auto rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        bool placed_all = true;
+        std::vector<std::size_t> slots;
+        for (auto bucket : order) {
+            const auto &members = buckets[bucket];
+            if (members.empty()) {
+                break;
+            }
+
+            bool placed = false;
+            for (std::uint32_t displacement = 0; displacement < max_displacement and not placed; ++displacement) {
+                displacements_[bucket] = displacement;
+                slots.clear();
+                placed = true;
+                for (auto key : members) {
+                    auto slot = column_slot(key);
+                    if (columns_[slot] != empty_slot or std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                        placed = false;
+                        break;
+                    }
+                    slots.push_back(slot);
+                }
+            }
+            if (not placed) {
+                placed_all = false;
+                break;
+            }
+            for (std::size_t i = 0; i < members.size(); ++i) {
+                columns_[slots[i]] = members[i];
+            }
+        }
+
+        if (placed_all) {
+            return;
+        }
+    }
+    throw schema_error{"could not build column index"};
+}
+
+} // namespace sql
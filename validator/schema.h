@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "symbol.h"
+
+namespace sql {
+
+/**
+ * a table and the names of its columns
+ */
+struct TableDefinition {
+    std::string name;
+    std::vector<std::string> columns;
+};
+
+
+/**
+ * immutable set of tables and their columns.
+ *
+ * tables are found by indexing with the interned table name,
+ * columns with one probe into a perfect hash over (table, column) pairs.
+ * neither lookup allocates.
+ */
+class Schema {
+public:
+    explicit Schema(const std::vector<TableDefinition> &tables);
+
+    /**
+     * reads one table per line: `table column column ...`,
+     * names are separated by whitespace, empty lines and lines starting with `#` are skipped
+     * throws schema_error
+     */
+    static Schema parse(std::istream &input);
+
+    static Schema load(const std::string &path);
+
+    [[nodiscard]]
+    bool has_table(symbol_t table) const;
+
+    [[nodiscard]]
+    bool has_column(symbol_t table, symbol_t column) const;
+
+    [[nodiscard]]
+    std::size_t table_count() const { return table_count_; }
+
+    [[nodiscard]]
+    std::size_t column_count() const { return column_count_; }
+
+    /**
+     * unique per constructed schema, distinguishes cached results of different schemas
+     */
+    [[nodiscard]]
+    std::uint64_t generation() const { return generation_; }
+
+private:
+    static constexpr std::uint32_t no_table = 0xffffffff;
+
+    static constexpr std::uint64_t empty_slot = ~std::uint64_t{0};
+
+    [[nodiscard]]
+    std::uint32_t table_slot(symbol_t table) const;
+
+    [[nodiscard]]
+    std::size_t column_slot(std::uint64_t key) const;
+
+    void build_column_index(const std::vector<std::uint64_t> &keys);
+
+    std::uint64_t generation_;
+
+    std::size_t table_count_ = 0;
+
+    std::size_t column_count_ = 0;
+
+    // symbol id -> dense table number, only schemas intern names so the ids stay small
+    std::vector<std::uint32_t> tables_;
+
+    // perfect hash (hash and displace): bucket seeds and the keys placed in each slot
+    std::uint64_t seed_ = 0;
+    std::vector<std::uint32_t> displacements_;
+    std::vector<std::uint64_t> columns_;
+};
+
+
+/**
+ * the currently active schema, can be replaced while validators are running.
+ * a validator keeps the schema it was created with until it is destroyed.
+ */
+class SchemaSlot {
+public:
+    SchemaSlot() = default;
+
+    explicit SchemaSlot(std::shared_ptr<const Schema> schema) : current_{std::move(schema)} {}
+
+    [[nodiscard]]
+    std::shared_ptr<const Schema> load() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    void store(std::shared_ptr<const Schema> schema) {
+        current_.store(std::move(schema), std::memory_order_release);
+    }
+
+private:
+    std::atomic<std::shared_ptr<const Schema>> current_;
+};
+
+
+/**
+ * schema file could not be read or is malformed
+ */
+struct schema_error : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+} // namespace sql
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <variant>
+
+namespace sql {
+
+namespace state {
+
+struct Start {};
+
+/**
+ * if any transition was wrong, the FSM will stay in the invalid state no matter further tokens
+ */
+struct Invalid {};
+
+/**
+ * if the sequence of tokens is correct, the FSM is in the valid state
+ */
+struct Valid {};
+
+struct SelectStmt{};
+
+struct AllColumns{};
+
+struct NamedColumn{};
+
+struct MoreColumns{};
+
+struct FromClause{};
+
+struct TableName{};
+
+/**
+ * `column.` seen in the select list, the column name has to follow
+ */
+struct ColumnQualifier{};
+
+struct QualifiedColumn{};
+
+/**
+ * `AS` after a column, the alias has to follow
+ */
+struct ColumnAs{};
+
+struct AliasedColumn{};
+
+/**
+ * `AS` after the table name, the alias has to follow
+ */
+struct TableAs{};
+
+struct AliasedTable{};
+
+/**
+ * after `WHERE` or `AND`, a condition has to follow
+ */
+struct WhereClause{};
+
+/**
+ * identifier on the left side of a comparison, may still become a qualifier
+ */
+struct LeftColumn{};
+
+struct LeftQualifier{};
+
+struct LeftOperand{};
+
+struct ComparisonOp{};
+
+/**
+ * identifier on the right side of a comparison, may still become a qualifier
+ */
+struct RightColumn{};
+
+struct RightQualifier{};
+
+struct Condition{};
+
+} // namespace state
+
+
+/**
+ * variant of all possible states
+ */
+using State =
+    std::variant<state::Start, state::Invalid, state::Valid, state::SelectStmt, state::AllColumns, state::NamedColumn, state::MoreColumns,
+                    state::FromClause, state::TableName, state::ColumnQualifier, state::QualifiedColumn, state::ColumnAs,
+                    state::AliasedColumn, state::TableAs, state::AliasedTable, state::WhereClause, state::LeftColumn,
+                    state::LeftQualifier, state::LeftOperand, state::ComparisonOp, state::RightColumn, state::RightQualifier,
+                    state::Condition>;
+
+} // namespace sql
@@ -0,0 +1,94 @@
+#include "symbol.h"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace sql {
+
+namespace {
+
+constexpr char fold(char c) {
+    return (c >= 'A' and c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+} // namespace
+
+bool same_name(std::string_view lhs, std::string_view rhs) noexcept {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (fold(lhs[i]) != fold(rhs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t SymbolTable::FoldedHash::operator()(std::string_view name) const noexcept {
+    // FNV-1a over the folded characters
+    std::uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash ^= static_cast<unsigned char>(fold(c));
+        hash *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+bool SymbolTable::FoldedEqual::operator()(std::string_view lhs, std::string_view rhs) const noexcept {
+    return same_name(lhs, rhs);
+}
+
+SymbolTable &SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+symbol_t SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock lock{mutex_};
+        auto found = ids_.find(name);
+        if (found != ids_.end()) {
+            return found->second;
+        }
+    }
+
+    std::unique_lock lock{mutex_};
+    // another thread may have registered it in between
+    auto found = ids_.find(name);
+    if (found != ids_.end()) {
+        return found->second;
+    }
+    if (names_.size() >= no_symbol) {
+        throw std::length_error{"symbol table full"};
+    }
+
+    auto &stored = names_.emplace_back(name);
+    for (char &c : stored) {
+        c = fold(c);
+    }
+    auto id = static_cast<symbol_t>(names_.size() - 1);
+    ids_.emplace(stored, id);
+    return id;
+}
+
+symbol_t SymbolTable::find(std::string_view name) const {
+    std::shared_lock lock{mutex_};
+    auto found = ids_.find(name);
+    return found == ids_.end() ? no_symbol : found->second;
+}
+
+std::string_view SymbolTable::name(symbol_t id) const {
+    std::shared_lock lock{mutex_};
+    if (id >= names_.size()) {
+        throw std::out_of_range{"unknown symbol"};
+    }
+    return names_[id];
+}
+
+std::size_t SymbolTable::size() const {
+    std::shared_lock lock{mutex_};
+    return names_.size();
+}
+
+} // namespace sql
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace sql {
+
+/**
+ * interned identifier, equal names share one id
+ */
+using symbol_t = std::uint32_t;
+
+inline constexpr symbol_t no_symbol = std::numeric_limits<symbol_t>::max();
+
+/**
+ * whether two spellings name the same identifier, ASCII case is ignored
+ */
+[[nodiscard]]
+bool same_name(std::string_view lhs, std::string_view rhs) noexcept;
+
+
+/**
+ * thread safe interning table for identifiers.
+ * SQL identifiers are case insensitive, so names are stored ASCII-lowercased
+ * and lookups ignore case. Ids are dense and never reused.
+ */
+class SymbolTable {
+public:
+    SymbolTable() = default;
+
+    SymbolTable(const SymbolTable &) = delete;
+
+    SymbolTable &operator=(const SymbolTable &) = delete;
+
+    /**
+     * the table used by tokens and schemas, only schemas add names to it
+     */
+    static SymbolTable &global();
+
+    /**
+     * id of `name`, registering it if it is new
+     */
+    symbol_t intern(std::string_view name);
+
+    /**
+     * id of `name` or `no_symbol`, never allocates
+     */
+    [[nodiscard]]
+    symbol_t find(std::string_view name) const;
+
+    /**
+     * folded spelling of an interned id
+     */
+    [[nodiscard]]
+    std::string_view name(symbol_t id) const;
+
+    [[nodiscard]]
+    std::size_t size() const;
+
+private:
+    struct FoldedHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view name) const noexcept;
+    };
+
+    struct FoldedEqual {
+        using is_transparent = void;
+        bool operator()(std::string_view lhs, std::string_view rhs) const noexcept;
+    };
+
+    mutable std::shared_mutex mutex_;
+
+    // deque keeps the strings in place, so the map keys and returned views stay valid
+    std::deque<std::string> names_;
+
+    std::unordered_map<std::string_view, symbol_t, FoldedHash, FoldedEqual> ids_;
+};
+
+} // namespace sql
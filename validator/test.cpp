@@ -2,6 +2,8 @@
 #include "validator.h"
 
 #include <iostream>
+#include <memory>
+#include <sstream>
 
 std::vector<sql::Token> valid_token_stream() {
     std::vector<sql::Token> tokens;
@@ -27,6 +29,37 @@ std::vector<sql::Token> invalid_token_stream() {
     return tokens;
 }
 
+std::vector<sql::Token> where_token_stream() {
+    std::vector<sql::Token> tokens;
+
+    // SELECT t.id AS key, name FROM MY_TABLE AS t WHERE t.id >= 10 AND name = 'x';
+    tokens.emplace_back(sql::token::Select{});
+    tokens.emplace_back(sql::token::Identifier{"t"});
+    tokens.emplace_back(sql::token::Dot{});
+    tokens.emplace_back(sql::token::Identifier{"id"});
+    tokens.emplace_back(sql::token::As{});
+    tokens.emplace_back(sql::token::Identifier{"key"});
+    tokens.emplace_back(sql::token::Comma{});
+    tokens.emplace_back(sql::token::Identifier{"name"});
+    tokens.emplace_back(sql::token::From{});
+    tokens.emplace_back(sql::token::Identifier{"MY_TABLE"});
+    tokens.emplace_back(sql::token::As{});
+    tokens.emplace_back(sql::token::Identifier{"t"});
+    tokens.emplace_back(sql::token::Where{});
+    tokens.emplace_back(sql::token::Identifier{"t"});
+    tokens.emplace_back(sql::token::Dot{});
+    tokens.emplace_back(sql::token::Identifier{"id"});
+    tokens.emplace_back(sql::token::Comparison{sql::token::Comparison::Op::GreaterEqual});
+    tokens.emplace_back(sql::token::Literal{"10"});
+    tokens.emplace_back(sql::token::And{});
+    tokens.emplace_back(sql::token::Identifier{"name"});
+    tokens.emplace_back(sql::token::Comparison{sql::token::Comparison::Op::Equal});
+    tokens.emplace_back(sql::token::Literal{"'x'"});
+    tokens.emplace_back(sql::token::Semicolon{});
+
+    return tokens;
+}
+
 int main() {
     // Change to get an invalid token stream
     bool get_valid_tokens = true;
@@ -44,4 +77,42 @@ int main() {
         std::cout << "Query not valid\n";
     }
 
+    if (sql::is_valid_sql_query(where_token_stream())) {
+        std::cout << "WHERE query valid\n";
+    } else {
+        std::cout << "WHERE query not valid\n";
+    }
+
+    // the same queries checked against a schema
+    std::istringstream schema_file{"MY_TABLE id name\nOTHER_TABLE id\n"};
+    sql::SchemaSlot schema{std::make_shared<const sql::Schema>(sql::Schema::parse(schema_file))};
+
+    if (sql::is_valid_sql_query(where_token_stream(), schema.load())) {
+        std::cout << "WHERE query matches schema\n";
+    } else {
+        std::cout << "WHERE query does not match schema\n";
+    }
+
+    std::istringstream renamed_file{"MY_TABLE key value\n"};
+    schema.store(std::make_shared<const sql::Schema>(sql::Schema::parse(renamed_file)));
+
+    if (sql::is_valid_sql_query(where_token_stream(), schema.load())) {
+        std::cout << "WHERE query matches new schema\n";
+    } else {
+        std::cout << "WHERE query does not match new schema\n";
+    }
+
+    // query texts, the second one only differs in whitespace and case and is answered from the cache
+    sql::ValidationCache cache{1024};
+    for (auto query : {"SELECT key, value FROM my_table WHERE key > 3;",
+                       "select  KEY ,value\n  from MY_TABLE where Key>3 ;"}) {
+        if (sql::is_valid_sql_query(query, cache, schema.load())) {
+            std::cout << "Query text valid\n";
+        } else {
+            std::cout << "Query text not valid\n";
+        }
+    }
+    auto stats = cache.stats();
+    std::cout << "Cache hits: " << stats.hits << ", misses: " << stats.misses << "\n";
+
 }
@@ -1,9 +1,35 @@
 #include "token.h"
 
+#include <utility>
+
 namespace sql {
-Token::Token(token_type value) : value_(value) {}
+namespace token {
+Identifier::Identifier(std::string_view name) : id{SymbolTable::global().find(name)} {
+    if (id == no_symbol) {
+        spelling = name;
+    }
+}
+
+std::string_view Identifier::name() const {
+    return id == no_symbol ? std::string_view{spelling} : SymbolTable::global().name(id);
+}
+
+symbol_t Identifier::symbol() const {
+    return id == no_symbol ? SymbolTable::global().find(spelling) : id;
+}
+
+bool operator==(const Identifier &lhs, const Identifier &rhs) {
+    if (lhs.id != no_symbol and rhs.id != no_symbol) {
+        return lhs.id == rhs.id;
+    }
+    return same_name(lhs.name(), rhs.name());
+}
+
+} // namespace token
+
+Token::Token(token_type value) : value_(std::move(value)) {}
 
-auto Token::value() const -> token_type {
+auto Token::value() const -> const token_type & {
     return this->value_;
 }
 
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <variant>
 
+#include "symbol.h"
+
 namespace sql {
 
 namespace token {
@@ -12,8 +15,34 @@ namespace token {
  */
 struct Select {};
 
+/**
+ * identifiers carry the id of their name in `SymbolTable::global`.
+ * building one only looks the name up, query text never grows the table: a name no schema
+ * defines gets `no_symbol` and keeps its spelling, so aliases can still be compared.
+ */
 struct Identifier {
-    std::string name;
+    Identifier(std::string_view name);
+
+    explicit Identifier(symbol_t id) : id{id} {}
+
+    [[nodiscard]]
+    std::string_view name() const;
+
+    /**
+     * the id, a name that was unknown when the token was built is looked up again
+     */
+    [[nodiscard]]
+    symbol_t symbol() const;
+
+    /**
+     * same name, ignoring case
+     */
+    friend bool operator==(const Identifier &lhs, const Identifier &rhs);
+
+    symbol_t id;
+
+    // only kept for names without an id
+    std::string spelling;
 };
 
 /**
@@ -27,6 +56,29 @@ struct  Asterisks{};
 
 struct Semicolon{};
 
+struct Dot{};
+
+struct As{};
+
+struct Where{};
+
+struct And{};
+
+/**
+ * binary comparison inside a WHERE condition
+ */
+struct Comparison {
+    enum class Op { Equal, NotEqual, Less, LessEqual, Greater, GreaterEqual };
+    Op op = Op::Equal;
+};
+
+/**
+ * numeric or string constant, kept verbatim
+ */
+struct Literal {
+    std::string text;
+};
+
 } // namespace token
 
 
@@ -37,7 +89,8 @@ class Token {
 public:
 
     using token_type =
-        std::variant<token::Select, token::Identifier, token::From, token::Comma, token::Asterisks, token::Semicolon>;
+        std::variant<token::Select, token::Identifier, token::From, token::Comma, token::Asterisks, token::Semicolon,
+                     token::Dot, token::As, token::Where, token::And, token::Comparison, token::Literal>;
 
     Token() = delete;
 
@@ -46,7 +99,7 @@ public:
 
     // getter
     [[nodiscard]]
-    token_type value() const;
+    const token_type &value() const;
 
 private:
     token_type value_;
@@ -1,96 +1,87 @@
 #include "validator.h"
 
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "grammar.h"
+#include "lexer.h"
 #include "token.h"
 
 namespace sql {
 
-bool SqlValidator::is_valid() const {
-
-    return std::holds_alternative<state::Valid>(state_);
+State transition(const State &state, const Token &token) {
+    return grammar::states[grammar::transitions[state.index()][token.value().index()].next];
 }
 
-void SqlValidator::handle(const Token &token) {
-
-    state_ = std::visit([&](auto cur) -> State {
-        return transition(cur,token);
-    }, state_);
-
-    /*auto lambda = [&](auto cur) -> State {
-        return transition(cur,token);
-    };
-    state_ = std::visit(lambda,state_);*/
-}
-
-struct TransitionFromStartVisitor {
-    // only the `Select` token advances the FSM from the `Start` state
-    State operator()(token::Select) const { return state::SelectStmt{}; }
-
-    State operator()(auto) const { return state::Invalid{}; }
-};
+SqlValidator::SqlValidator(std::shared_ptr<const Schema> schema) : schema_{std::move(schema)} {}
 
-State transition(state::Start, const Token &token) {
-    return std::visit(TransitionFromStartVisitor{}, token.value());
-}
+bool SqlValidator::is_valid() const {
 
-State transition(state::Valid, const Token &token) {
-    if(token.value().index() == 5)
-        return state::Valid{};
-    else
-        return state::Invalid{};
+    return state_ == grammar::valid;
 }
 
-State transition(state::Invalid, const Token &token) {
-    return state::Invalid{};
+State SqlValidator::state() const {
+    return grammar::states[state_];
 }
 
-struct TransitionSelectStmtVisitor {
-    State operator() (token::Asterisks) const { return state::AllColumns{}; }
-    State operator() (token::Identifier) const { return state::NamedColumn{}; }
-    State operator() (auto) const { return state::Invalid{}; }
-};
+void SqlValidator::handle(const Token &token) {
 
-State transition(state::SelectStmt, const Token &token){
-    return std::visit(TransitionSelectStmtVisitor{}, token.value());
-}
+    const auto &[next, action] = grammar::transitions[state_][token.value().index()];
+    state_ = next;
 
-State transition(state::AllColumns, const Token &token){
-    if(token.value().index() == 2)
-        return state::FromClause{};
-    else
-        return state::Invalid{};
+    if (schema_ and action != grammar::Action::None) {
+        apply(action, token);
+    }
 }
 
-struct TransitionNamedColumnVisitor{
-    State operator() (token::From) const { return state::FromClause{}; }
-    State operator() (token::Comma) const { return state::MoreColumns{}; }
-    State operator() (auto) const { return state::Invalid{}; }
-};
-State transition(state::NamedColumn, const Token &token){
-    return std::visit(TransitionNamedColumnVisitor{}, token.value());
-}
+void SqlValidator::apply(grammar::Action action, const Token &token) {
+    using grammar::Action;
 
-State transition(state::MoreColumns, const Token &token){
-    if(token.value().index() == 1)
-        return state::NamedColumn{};
-    else
-        return state::Invalid{};
-}
+    // the grammar only attaches name actions to identifiers
+    auto name = [&token]() -> const token::Identifier & {
+        return std::get<token::Identifier>(token.value());
+    };
 
-State transition(state::FromClause, const Token &token){
-    if(token.value().index() == 1)
-        return state::TableName{};
-    else
-        return state::Invalid{};
+    switch (action) {
+    case Action::None:
+        break;
+    case Action::Column:
+        columns_.push_back({std::nullopt, name()});
+        break;
+    case Action::Qualify:
+        columns_.back().qualifier = std::exchange(columns_.back().column, token::Identifier{no_symbol});
+        break;
+    case Action::QualifiedName:
+        columns_.back().column = name();
+        break;
+    case Action::Table:
+        table_ = name().symbol();
+        break;
+    case Action::TableAlias:
+        alias_ = name();
+        break;
+    case Action::Resolve:
+        if (not resolve()) {
+            state_ = grammar::invalid;
+        }
+        break;
+    }
 }
 
-State transition(state::TableName, const Token &token){
-    if(token.value().index() == 5)
-        return state::Valid{};
-    else
-        return state::Invalid{};
+bool SqlValidator::resolve() const {
+    if (not schema_->has_table(table_)) {
+        return false;
+    }
+    for (const auto &[qualifier, column] : columns_) {
+        if (qualifier and not (alias_ and *qualifier == *alias_) and qualifier->symbol() != table_) {
+            return false;
+        }
+        if (not schema_->has_column(table_, column.symbol())) {
+            return false;
+        }
+    }
+    return true;
 }
 
 [[nodiscard]]
@@ -101,4 +92,33 @@ bool is_valid_sql_query(const std::vector<Token> &tokens){
     }
     return sqlValidator.is_valid();
 }
+
+[[nodiscard]]
+bool is_valid_sql_query(const std::vector<Token> &tokens, std::shared_ptr<const Schema> schema){
+    SqlValidator sqlValidator{std::move(schema)};
+    for(const auto& item : tokens){
+        sqlValidator.handle(item);
+    }
+    return sqlValidator.is_valid();
+}
+
+[[nodiscard]]
+bool is_valid_sql_query(std::string_view query, ValidationCache &cache, std::shared_ptr<const Schema> schema){
+    // a hit only costs the fingerprint scan, which builds no tokens and doesn't touch the
+    // symbol table. a miss reads the text a second time to tokenize it
+    std::uint64_t key = fingerprint(query);
+    if (schema) {
+        key ^= schema->generation() * 0x9e3779b97f4a7c15ull;
+    }
+
+    if (auto cached = cache.find(key)) {
+        return *cached;
+    }
+
+    auto lexed = tokenize(query);
+    bool valid = lexed.complete and (schema ? is_valid_sql_query(lexed.tokens, std::move(schema))
+                                            : is_valid_sql_query(lexed.tokens));
+    cache.insert(key, valid);
+    return valid;
+}
 } // namespace sql
@@ -1,100 +1,92 @@
 #pragma once
 
-#include <variant>
+#include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
 
+#include "cache.h"
+#include "grammar.h"
+#include "schema.h"
+#include "state.h"
+#include "symbol.h"
 #include "token.h"
 
 namespace sql {
 
-namespace state {
-
-struct Start {};
-
 /**
- * if any transition was wrong, the FSM will stay in the invalid state no matter further tokens
+ * the next state for a given state and token, looked up in the table generated from `grammar::rules`
  */
-struct Invalid {};
+[[nodiscard]]
+State transition(const State &state, const Token &token);
 
 /**
- * if the sequence of tokens is correct, the FSM is in the valid state
+ * the initial state is `Start`, moves to the next state based on the given tokens
+ * query with`is_valid`
+ *
+ * with a schema, the table and every column reference also have to exist in it,
+ * qualifiers have to name the table or its alias
  */
-struct Valid {};
-
-struct SelectStmt{};
-
-struct AllColumns{};
-
-struct NamedColumn{};
-
-struct MoreColumns{};
-
-struct FromClause{};
+class SqlValidator {
+public:
+    SqlValidator() = default;
 
-struct TableName{};
+    explicit SqlValidator(std::shared_ptr<const Schema> schema);
 
-} // namespace state
+    [[nodiscard]]
+    bool is_valid() const;
 
+    [[nodiscard]]
+    State state() const;
 
 /**
- * variant of all possible states
+ * moves from one state to the next
  */
-using State =
-    std::variant<state::Start, state::Invalid, state::Valid, state::SelectStmt, state::AllColumns, state::NamedColumn, state::MoreColumns,
-                    state::FromClause, state::TableName>;
+    void handle(const Token &token);
 
+private:
+    struct ColumnRef {
+        std::optional<token::Identifier> qualifier;
+        token::Identifier column;
+    };
 
-[[nodiscard]]
-State transition(state::Start, const Token &token);
+    void apply(grammar::Action action, const Token &token);
 
-[[nodiscard]]
-State transition(state::Valid, const Token &token);
+    [[nodiscard]]
+    bool resolve() const;
 
-[[nodiscard]]
-State transition(state::Invalid, const Token &token);
+    grammar::state_id state_ = grammar::start;
 
-[[nodiscard]]
-State transition(state::SelectStmt, const Token &token);
+    std::shared_ptr<const Schema> schema_;
 
-[[nodiscard]]
-State transition(state::AllColumns, const Token &token);
+    // references are collected until the table is known
+    std::vector<ColumnRef> columns_;
 
-[[nodiscard]]
-State transition(state::NamedColumn, const Token &token);
+    symbol_t table_ = no_symbol;
 
-[[nodiscard]]
-State transition(state::MoreColumns, const Token &token);
+    // aliases are usually not in the schema, they are compared by name
+    std::optional<token::Identifier> alias_;
+};
 
-[[nodiscard]]
-State transition(state::FromClause, const Token &token);
-
-[[nodiscard]]
-State transition(state::TableName, const Token &token);
 
 /**
- * the initial state is `Start`, moves to the next state based on the given tokens
- * query with`is_valid`
+ * return true if a sequence of tokens is valid
  */
-class SqlValidator {
-public:
-    SqlValidator() = default;
-
-    [[nodiscard]]
-    bool is_valid() const;
+[[nodiscard]]
+bool is_valid_sql_query(const std::vector<Token> &tokens);
 
 /**
- * moves from one state to the next
+ * return true if a sequence of tokens is valid and only refers to tables and columns of `schema`
  */
-    void handle(const Token &token);
-
-private:
-    State state_ = state::Start{};
-};
-
+[[nodiscard]]
+bool is_valid_sql_query(const std::vector<Token> &tokens, std::shared_ptr<const Schema> schema);
 
 /**
- * return true if a sequence of tokens is valid
+ * return true if a query text is valid (and matches `schema`, if given).
+ * results are cached by the query fingerprint, a repeated query is only hashed
+ * and neither turned into tokens nor run through the FSM. queries whose fingerprints share the cache tag (63 bits,
+ * see ValidationCache) share a result.
  */
 [[nodiscard]]
-bool is_valid_sql_query(const std::vector<Token> &tokens);
+bool is_valid_sql_query(std::string_view query, ValidationCache &cache, std::shared_ptr<const Schema> schema = nullptr);
 } // namespace sql